@@ -0,0 +1,252 @@
+#include "bin_stats.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// Quantile targets (Q16) and their P² desired-position increments
+static const int32_t quantile_p_q16[BIN_STATS_NUM_QUANTILES] = {
+    32768,  // 0.50
+    62259,  // 0.95
+    64881,  // 0.99
+};
+
+static bin_stats_t stats[BIN_STATS_MAX_BINS];
+static int stats_bins = 0;
+static uint8_t stats_threshold = BIN_STATS_THRESHOLD_DEFAULT;
+
+// Measured cost of bin_stats_update() since the last reset. P² marker moves
+// divide 64-bit values in software, so the bound is measured, not derived.
+static uint32_t update_us_max = 0;
+static uint64_t update_us_total = 0;
+static uint32_t update_calls = 0;
+
+// Derived values captured when a snapshot is requested, printed one bin per poll
+typedef struct {
+    uint32_t count;
+    uint32_t above;
+    uint16_t mean_q8;
+    uint16_t std_q8;
+    uint16_t quantile_q8[BIN_STATS_NUM_QUANTILES];
+    uint8_t min;
+    uint8_t max;
+} bin_stats_summary_t;
+
+static bin_stats_summary_t summary[BIN_STATS_MAX_BINS];
+static int snapshot_bins = 0;
+static uint32_t snapshot_us_max = 0;
+static uint32_t snapshot_us_avg = 0;
+static int snapshot_next = -1;  // -1 = idle, 0 = header pending, 1.. = bin lines
+
+// Desired position increment dn_i (Q16) of marker i for quantile p
+static inline int32_t p2_increment(int i, int32_t p_q16) {
+    switch (i) {
+        case 0:  return 0;
+        case 1:  return p_q16 / 2;
+        case 2:  return p_q16;
+        case 3:  return (65536 + p_q16) / 2;
+        default: return 65536;
+    }
+}
+
+// Piecewise-parabolic prediction of marker i moved by ds (P² formula)
+static int32_t p2_parabolic(const p2_quantile_t* s, int i, int ds) {
+    int32_t n0 = s->n[i - 1];
+    int32_t n1 = s->n[i];
+    int32_t n2 = s->n[i + 1];
+
+    int64_t a = (int64_t)(n1 - n0 + ds) * (s->q[i + 1] - s->q[i]) / (n2 - n1);
+    int64_t b = (int64_t)(n2 - n1 - ds) * (s->q[i] - s->q[i - 1]) / (n1 - n0);
+    return s->q[i] + (int32_t)((ds * (a + b)) / (n2 - n0));
+}
+
+// Add one observation; count includes it. Each of the three inner markers
+// moves at most one position, so the cost per call is bounded.
+static void p2_update(p2_quantile_t* s, int32_t x_q20, uint32_t count, int32_t p_q16) {
+    if (count <= 5) {
+        // Collect the first five observations in sorted order
+        int i = count - 1;
+        while (i > 0 && s->q[i - 1] > x_q20) {
+            s->q[i] = s->q[i - 1];
+            i--;
+        }
+        s->q[i] = x_q20;
+        s->n[count - 1] = count;
+        return;
+    }
+
+    // Find the cell containing x, extending the extremes if needed
+    int k;
+    if (x_q20 < s->q[0]) {
+        s->q[0] = x_q20;
+        k = 0;
+    } else if (x_q20 >= s->q[4]) {
+        s->q[4] = x_q20;
+        k = 3;
+    } else {
+        k = 0;
+        while (x_q20 >= s->q[k + 1]) k++;
+    }
+
+    for (int i = k + 1; i < 5; i++) {
+        s->n[i]++;
+    }
+
+    // Adjust the inner markers towards their desired positions
+    for (int i = 1; i <= 3; i++) {
+        int64_t desired_q16 = 65536 + (int64_t)(count - 1) * p2_increment(i, p_q16);
+        int64_t d = desired_q16 - ((int64_t)s->n[i] << 16);
+
+        int ds;
+        if (d >= 65536 && s->n[i + 1] - s->n[i] > 1) {
+            ds = 1;
+        } else if (d <= -65536 && s->n[i - 1] - s->n[i] < -1) {
+            ds = -1;
+        } else {
+            continue;
+        }
+
+        int32_t q = p2_parabolic(s, i, ds);
+        if (s->q[i - 1] < q && q < s->q[i + 1]) {
+            s->q[i] = q;
+        } else {
+            // Parabola overshoots a neighbour: fall back to linear
+            s->q[i] += ds * (s->q[i + ds] - s->q[i]) / (s->n[i + ds] - s->n[i]);
+        }
+        s->n[i] += ds;
+    }
+}
+
+// Current quantile estimate (Q8), also valid before five observations
+static int32_t p2_value(const p2_quantile_t* s, uint32_t count, int32_t p_q16) {
+    if (count == 0) return 0;
+    int32_t q;
+    if (count < 5) {
+        q = s->q[((count - 1) * p_q16 + 32768) >> 16];
+    } else {
+        q = s->q[2];
+    }
+    return (q + (1 << 11)) >> 12;
+}
+
+// Clear all statistics
+void bin_stats_reset(void) {
+    memset(stats, 0, sizeof(stats));
+    stats_bins = 0;
+    update_us_max = 0;
+    update_us_total = 0;
+    update_calls = 0;
+}
+
+void bin_stats_set_threshold(uint8_t threshold) {
+    stats_threshold = threshold;
+}
+
+uint8_t bin_stats_get_threshold(void) {
+    return stats_threshold;
+}
+
+// Update every bin with one received frame (called from process_packet)
+void bin_stats_update(const uint8_t* bins, int num_bins) {
+    uint32_t start_us = time_us_32();
+    if (num_bins > BIN_STATS_MAX_BINS) num_bins = BIN_STATS_MAX_BINS;
+    if (num_bins > stats_bins) stats_bins = num_bins;
+
+    for (int b = 0; b < num_bins; b++) {
+        bin_stats_t* s = &stats[b];
+        uint8_t x = bins[b];
+        uint32_t count = ++s->count;
+
+        s->sum += x;
+        s->sum_sq += (uint32_t)x * x;
+
+        if (count == 1 || x < s->min) s->min = x;
+        if (x > s->max) s->max = x;
+        if (x > stats_threshold) s->above++;
+
+        for (int i = 0; i < BIN_STATS_NUM_QUANTILES; i++) {
+            p2_update(&s->quantile[i], (int32_t)x << 20, count, quantile_p_q16[i]);
+        }
+    }
+
+    uint32_t elapsed_us = time_us_32() - start_us;
+    if (elapsed_us > update_us_max) update_us_max = elapsed_us;
+    update_us_total += elapsed_us;
+    update_calls++;
+}
+
+// Capture derived values for all bins; printing then happens one line per
+// bin_stats_snapshot_poll() call so reception is never held up for long
+bool bin_stats_snapshot_begin(void) {
+    if (snapshot_next >= 0) return false;
+
+    for (int b = 0; b < stats_bins; b++) {
+        const bin_stats_t* s = &stats[b];
+        bin_stats_summary_t* out = &summary[b];
+
+        out->count = s->count;
+        out->above = s->above;
+        out->min = s->min;
+        out->max = s->max;
+        out->mean_q8 = (s->count > 0) ? (uint16_t)(((s->sum << 8) + s->count / 2) / s->count) : 0;
+
+        // Sample variance from the sums (cost only matters per snapshot).
+        // sum_sq stays below 2^48 for a 32-bit count, so double holds it
+        // exactly; sum * sum does not fit and rounds to 53 bits, a relative
+        // error far below the Q8 result.
+        double variance = 0.0;
+        if (s->count > 1) {
+            variance = ((double)s->sum_sq - (double)s->sum * (double)s->sum / s->count) / (s->count - 1);
+            if (variance < 0.0) variance = 0.0;
+        }
+        out->std_q8 = (uint16_t)(sqrt(variance) * 256.0 + 0.5);
+
+        for (int i = 0; i < BIN_STATS_NUM_QUANTILES; i++) {
+            out->quantile_q8[i] = (uint16_t)p2_value(&s->quantile[i], s->count, quantile_p_q16[i]);
+        }
+    }
+
+    snapshot_bins = stats_bins;
+    snapshot_us_max = update_us_max;
+    snapshot_us_avg = update_calls ? (uint32_t)(update_us_total / update_calls) : 0;
+    snapshot_next = 0;
+    return true;
+}
+
+static void print_q8(uint16_t v) {
+    printf("%u.%02u", v >> 8, ((v & 0xFF) * 100) >> 8);
+}
+
+// Print the next line of a pending snapshot; returns true while lines remain
+bool bin_stats_snapshot_poll(void) {
+    if (snapshot_next < 0) return false;
+
+    if (snapshot_next == 0) {
+        uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+        printf("STATS bins=%d threshold=%u update_us=%u max (%u cycles) %u avg\n", snapshot_bins, stats_threshold,
+               snapshot_us_max, snapshot_us_max * mhz, snapshot_us_avg);
+        printf("bin,hz,count,mean,std,min,max,p50,p95,p99,above\n");
+    } else if (snapshot_next <= snapshot_bins) {
+        int b = snapshot_next - 1;
+        const bin_stats_summary_t* s = &summary[b];
+
+        printf("%d,%d,%u,", b, 500 + 125 * b, s->count);
+        print_q8(s->mean_q8);
+        printf(",");
+        print_q8(s->std_q8);
+        printf(",%u,%u,", s->min, s->max);
+        for (int i = 0; i < BIN_STATS_NUM_QUANTILES; i++) {
+            print_q8(s->quantile_q8[i]);
+            printf(",");
+        }
+        printf("%u\n", s->above);
+    } else {
+        printf("END\n");
+        snapshot_next = -1;
+        return false;
+    }
+
+    snapshot_next++;
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef BIN_STATS_H
+#define BIN_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Long-running per-bin statistics for beamformer tuning:
+// mean/variance, min/max, P² streaming quantiles (p50/p95/p99) and a count
+// of frames above a threshold. All updates are integer.
+//
+// Mean and variance come from exact 64-bit sums of x and x², divided only
+// when a snapshot is taken. A running mean updated with integer division
+// (Welford) stops moving once count exceeds the Q16 step (~2^24 frames,
+// 3 days at 60 frames/s). The sums themselves cannot overflow, but the
+// 32-bit count and the signed P² marker positions limit a run to 2^31
+// frames (about 414 days at 60 frames/s): past that the marker positions
+// overflow, and at 2^32 count wraps, which resets min and restarts the
+// quantiles. Reset the statistics before then.
+//
+// Memory is fixed at compile time: sizeof(bin_stats_t) = 152 bytes per bin
+// plus a 20-byte summary per bin for snapshots (172 bytes per bin in total):
+//   40 bins  (default)        ->  6880 bytes
+//   128 bins (larger masters) -> 22016 bytes
+#ifndef BIN_STATS_MAX_BINS
+#define BIN_STATS_MAX_BINS 40
+#endif
+
+#define BIN_STATS_THRESHOLD_DEFAULT 64
+#define BIN_STATS_NUM_QUANTILES 3  // p50, p95, p99
+
+// P² estimator: five markers per quantile. Heights carry 20 fraction bits:
+// a marker moves by (height gap / position gap) per step, which in Q8 rounds
+// to zero once the markers are a few thousand frames apart.
+typedef struct {
+    int32_t q[5];  // Marker heights, Q20
+    int32_t n[5];  // Marker positions (1-based)
+} p2_quantile_t;
+
+typedef struct {
+    uint64_t sum;        // Sum of x
+    uint64_t sum_sq;     // Sum of x²
+    uint32_t count;
+    uint32_t above;      // Frames above the threshold
+    uint8_t min;
+    uint8_t max;
+    p2_quantile_t quantile[BIN_STATS_NUM_QUANTILES];
+} bin_stats_t;
+
+// Function prototypes
+void bin_stats_reset(void);
+void bin_stats_update(const uint8_t* bins, int num_bins);
+void bin_stats_set_threshold(uint8_t threshold);
+uint8_t bin_stats_get_threshold(void);
+bool bin_stats_snapshot_begin(void);
+bool bin_stats_snapshot_poll(void);
+
+#endif // BIN_STATS_H
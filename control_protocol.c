@@ -0,0 +1,158 @@
+#include "control_protocol.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+
+#define MAX_BYTES_PER_CALL 32  // Bound the work done per main-loop pass
+
+// Receive ring: filled by control_usb_task(), drained by control_poll()
+static uint8_t ring[CONTROL_RING_SIZE];
+static volatile uint32_t ring_head = 0;  // Write position
+static volatile uint32_t ring_tail = 0;  // Read position
+
+volatile uint32_t control_frames_ok = 0;
+volatile uint32_t control_crc_errors = 0;
+volatile uint32_t control_ring_overflows = 0;
+
+// Frame parser state
+typedef enum {
+    PARSE_SOF,
+    PARSE_CMD,
+    PARSE_LEN_LO,
+    PARSE_LEN_HI,
+    PARSE_PAYLOAD,
+    PARSE_CRC,
+    PARSE_DISCARD,  // Skipping the payload and crc of a rejected frame
+} parse_state_t;
+
+static parse_state_t parse_state = PARSE_SOF;
+static uint8_t frame_cmd;
+static uint16_t frame_len;
+static uint16_t frame_pos;
+static uint32_t discard_left;  // Bytes of a rejected frame still to skip
+static uint8_t frame_crc;
+static uint8_t frame_payload[CONTROL_MAX_PAYLOAD];
+static uint32_t frame_last_byte_ms;
+
+static uint8_t crc8_update(uint8_t crc, uint8_t byte) {
+    crc ^= byte;
+    for (int i = 0; i < 8; i++) {
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+// Move whatever the USB stack has buffered into the ring (never blocks)
+void control_usb_task(void) {
+    for (int i = 0; i < MAX_BYTES_PER_CALL; i++) {
+        int c = getchar_timeout_us(0);
+        if (c == PICO_ERROR_TIMEOUT) break;
+
+        uint32_t head = ring_head;
+        if (head - ring_tail >= CONTROL_RING_SIZE) {
+            control_ring_overflows++;
+            continue;
+        }
+        ring[head & (CONTROL_RING_SIZE - 1)] = (uint8_t)c;
+        ring_head = head + 1;
+    }
+}
+
+static void parse_byte(uint8_t byte) {
+    switch (parse_state) {
+        case PARSE_SOF:
+            if (byte == CONTROL_SOF) {
+                parse_state = PARSE_CMD;
+                frame_crc = 0;
+            } else {
+                control_handle_text((char)byte);
+            }
+            break;
+
+        case PARSE_CMD:
+            frame_cmd = byte;
+            frame_crc = crc8_update(frame_crc, byte);
+            parse_state = PARSE_LEN_LO;
+            break;
+
+        case PARSE_LEN_LO:
+            frame_len = byte;
+            frame_crc = crc8_update(frame_crc, byte);
+            parse_state = PARSE_LEN_HI;
+            break;
+
+        case PARSE_LEN_HI:
+            frame_len |= (uint16_t)byte << 8;
+            frame_crc = crc8_update(frame_crc, byte);
+            frame_pos = 0;
+            if (frame_len > CONTROL_MAX_PAYLOAD) {
+                // Skip the rest of the frame so its payload is not taken for
+                // text commands; the inter-byte timeout still resynchronizes
+                // if the sender stops early
+                control_send_nak(frame_cmd, CONTROL_ERR_LENGTH);
+                discard_left = (uint32_t)frame_len + 1;
+                parse_state = PARSE_DISCARD;
+            } else {
+                parse_state = (frame_len > 0) ? PARSE_PAYLOAD : PARSE_CRC;
+            }
+            break;
+
+        case PARSE_PAYLOAD:
+            frame_payload[frame_pos++] = byte;
+            frame_crc = crc8_update(frame_crc, byte);
+            if (frame_pos == frame_len) parse_state = PARSE_CRC;
+            break;
+
+        case PARSE_CRC:
+            parse_state = PARSE_SOF;
+            if (byte != frame_crc) {
+                control_crc_errors++;
+                break;
+            }
+            control_frames_ok++;
+            control_handle_command(frame_cmd, frame_payload, frame_len);
+            break;
+
+        case PARSE_DISCARD:
+            if (--discard_left == 0) parse_state = PARSE_SOF;
+            break;
+    }
+}
+
+// Parse buffered bytes and dispatch complete frames (main loop, low priority)
+void control_poll(void) {
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+
+    // Resynchronize if a frame stalled halfway
+    if (parse_state != PARSE_SOF && (now - frame_last_byte_ms) > CONTROL_FRAME_TIMEOUT_MS) {
+        parse_state = PARSE_SOF;
+    }
+
+    for (int i = 0; i < MAX_BYTES_PER_CALL && ring_tail != ring_head; i++) {
+        uint8_t byte = ring[ring_tail & (CONTROL_RING_SIZE - 1)];
+        ring_tail++;
+        frame_last_byte_ms = now;
+        parse_byte(byte);
+    }
+}
+
+// Send one response frame (raw bytes, no newline translation)
+void control_send_frame(uint8_t cmd, const uint8_t* payload, uint16_t len) {
+    uint8_t header[3] = {cmd, len & 0xFF, len >> 8};
+    uint8_t crc = 0;
+
+    putchar_raw(CONTROL_RESPONSE_SOF);
+    for (int i = 0; i < 3; i++) {
+        putchar_raw(header[i]);
+        crc = crc8_update(crc, header[i]);
+    }
+    for (uint16_t i = 0; i < len; i++) {
+        putchar_raw(payload[i]);
+        crc = crc8_update(crc, payload[i]);
+    }
+    putchar_raw(crc);
+}
+
+void control_send_nak(uint8_t cmd, uint8_t error) {
+    uint8_t payload[2] = {cmd, error};
+    control_send_frame(CMD_NAK, payload, sizeof(payload));
+}
@@ -0,0 +1,73 @@
+#ifndef CONTROL_PROTOCOL_H
+#define CONTROL_PROTOCOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Framed binary command channel over USB CDC.
+//
+// Request:  0xA5 | cmd | len_lo | len_hi | payload[len] | crc8
+// Response: 0x5A | cmd|0x80 (or 0x7F NAK) | len_lo | len_hi | payload[len] | crc8
+// crc8: polynomial 0x07, init 0x00, over cmd, length and payload.
+// Bytes outside a frame are passed on as single-character text commands.
+#define CONTROL_SOF          0xA5
+#define CONTROL_RESPONSE_SOF 0x5A
+#define CONTROL_MAX_PAYLOAD  64     // Longest accepted request payload
+#define CONTROL_RING_SIZE    256    // USB receive ring (power of two)
+#define CONTROL_FRAME_TIMEOUT_MS 100  // Drop a partial frame after this gap
+
+// Commands
+#define CMD_PING         0x01  // -> empty response
+#define CMD_GET_PARAM    0x02  // [param]        -> [param][u32 value]
+#define CMD_SET_PARAM    0x03  // [param][u32]   -> [param][u32 value]
+#define CMD_GET_COUNTERS 0x04  // -> u32 counters (see README)
+#define CMD_SCREENSHOT   0x05  // -> [u16 width][u16 height], then one frame per row
+#define CMD_LOG_RECORD   0x06  // Unsolicited (binary log output): [core][u16 id][u32 us][u32 args...]
+#define CMD_HISTORY_INFO 0x07  // -> flash history statistics (see README)
+#define CMD_HISTORY_READ 0x08  // [u16 boot][u32 time_ms][u16 count] -> one frame per record, then empty frame
+#define CMD_GET_FEATURES 0x09  // -> current speech features and voice activity counters (see README)
+#define CMD_GET_CHANNELS 0x0A  // -> channel memory, frame cost, then per-channel counters (see README)
+#define CMD_RESPONSE     0x80
+#define CMD_NAK          0x7F  // [cmd][error]
+
+// NAK error codes
+#define CONTROL_ERR_UNKNOWN_CMD 0x01
+#define CONTROL_ERR_LENGTH      0x02
+#define CONTROL_ERR_PARAM       0x03
+#define CONTROL_ERR_VALUE       0x04
+#define CONTROL_ERR_BUSY        0x05
+
+// Parameters (all values are sent as little-endian u32)
+#define PARAM_DISPLAY_UPDATE_MS 0x01
+#define PARAM_SPECTROGRAM_DEPTH 0x02
+#define PARAM_PALETTE           0x03
+#define PARAM_GAIN_FLOOR        0x04
+#define PARAM_DEBUG_VERBOSE     0x05
+#define PARAM_I2C_ADDRESS       0x06
+#define PARAM_RENDER_MODE       0x07
+#define PARAM_FREQ_WARP         0x08
+#define PARAM_INTERP_TIME       0x09
+#define PARAM_STATS_THRESHOLD   0x0A
+#define PARAM_LOG_OUTPUT        0x0B
+#define PARAM_STRESS_MODE       0x0C
+#define PARAM_HISTORY_ENABLE    0x0D
+#define PARAM_TIME_LEVEL        0x0E
+#define PARAM_SCROLL_MODE       0x0F
+#define PARAM_CHANNELS          0x10
+
+// Channel counters
+extern volatile uint32_t control_frames_ok;
+extern volatile uint32_t control_crc_errors;
+extern volatile uint32_t control_ring_overflows;
+
+// Function prototypes
+void control_usb_task(void);
+void control_poll(void);
+void control_send_frame(uint8_t cmd, const uint8_t* payload, uint16_t len);
+void control_send_nak(uint8_t cmd, uint8_t error);
+
+// Implemented by the application
+void control_handle_command(uint8_t cmd, const uint8_t* payload, uint16_t len);
+void control_handle_text(char c);
+
+#endif // CONTROL_PROTOCOL_H
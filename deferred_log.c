@@ -0,0 +1,132 @@
+#include "deferred_log.h"
+#include "control_protocol.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+
+#define MAX_RECORDS_PER_DRAIN 4  // Bound the work done per main-loop pass
+
+// One ring per core. The owning core is the only writer (thread code and its
+// IRQs, serialized by briefly masking interrupts); Core 0 is the only reader.
+typedef struct {
+    log_record_t records[LOG_RING_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t dropped;
+    uint32_t dropped_reported;
+} log_ring_t;
+
+static log_ring_t rings[2];
+static log_output_t output_mode = LOG_OUTPUT_TEXT;
+
+#define LOG_MESSAGE_FORMAT(id, format) format,
+static const char* const log_formats[LOG_MESSAGE_COUNT] = {
+    LOG_MESSAGES(LOG_MESSAGE_FORMAT)
+};
+#undef LOG_MESSAGE_FORMAT
+
+// Append a record to the calling core's ring (tens of cycles, never blocks)
+void log_write(uint16_t id, uint8_t nargs, uint32_t a0, uint32_t a1, uint32_t a2) {
+    uint32_t core = get_core_num();
+    log_ring_t* ring = &rings[core];
+
+    uint32_t irq_state = save_and_disable_interrupts();
+    uint32_t head = ring->head;
+    if (head - ring->tail >= LOG_RING_SIZE) {
+        ring->dropped++;
+        restore_interrupts(irq_state);
+        return;
+    }
+
+    log_record_t* r = &ring->records[head & (LOG_RING_SIZE - 1)];
+    r->timestamp_us = time_us_32();
+    r->id = id;
+    r->nargs = nargs;
+    r->core = core;
+    r->args[0] = a0;
+    r->args[1] = a1;
+    r->args[2] = a2;
+
+    __dmb();  // Record contents visible before the new head
+    ring->head = head + 1;
+    restore_interrupts(irq_state);
+}
+
+static void log_output(const log_record_t* r) {
+    if (output_mode == LOG_OUTPUT_TEXT) {
+        const char* format = (r->id < LOG_MESSAGE_COUNT) ? log_formats[r->id] : "[Log] Unknown message %u";
+        printf(format, r->args[0], r->args[1], r->args[2]);
+        printf("\n");
+        return;
+    }
+
+    // [core][u16 id][u32 timestamp_us][u32 args...]
+    uint8_t payload[7 + 4 * LOG_MAX_ARGS];
+    payload[0] = r->core;
+    payload[1] = r->id & 0xFF;
+    payload[2] = r->id >> 8;
+    for (int i = 0; i < 4; i++) {
+        payload[3 + i] = r->timestamp_us >> (8 * i);
+    }
+    for (int a = 0; a < r->nargs; a++) {
+        for (int i = 0; i < 4; i++) {
+            payload[7 + a * 4 + i] = r->args[a] >> (8 * i);
+        }
+    }
+    control_send_frame(CMD_LOG_RECORD | CMD_RESPONSE, payload, 7 + 4 * r->nargs);
+}
+
+// Oldest pending record across both rings, or NULL
+static log_ring_t* oldest_ring(void) {
+    log_ring_t* best = NULL;
+    for (int core = 0; core < 2; core++) {
+        log_ring_t* ring = &rings[core];
+        if (ring->tail == ring->head) continue;
+        if (best == NULL ||
+            (int32_t)(ring->records[ring->tail & (LOG_RING_SIZE - 1)].timestamp_us -
+                      best->records[best->tail & (LOG_RING_SIZE - 1)].timestamp_us) < 0) {
+            best = ring;
+        }
+    }
+    return best;
+}
+
+// Format/send a few pending records (Core 0 main loop); returns true if any remain
+bool log_drain(void) {
+    for (int n = 0; n < MAX_RECORDS_PER_DRAIN; n++) {
+        // Report drops as soon as they are seen
+        for (int core = 0; core < 2; core++) {
+            log_ring_t* ring = &rings[core];
+            uint32_t dropped = ring->dropped;
+            if (dropped != ring->dropped_reported) {
+                log_record_t r = {time_us_32(), LOG_DROPPED, 2, core,
+                                  {dropped - ring->dropped_reported, core, 0}};
+                ring->dropped_reported = dropped;
+                log_output(&r);
+            }
+        }
+
+        log_ring_t* ring = oldest_ring();
+        if (ring == NULL) return false;
+
+        __dmb();  // Read the record only after seeing the head that published it
+        log_record_t r = ring->records[ring->tail & (LOG_RING_SIZE - 1)];
+        __dmb();  // Copy complete before the slot is handed back to the writer
+        ring->tail++;
+        log_output(&r);
+    }
+    return oldest_ring() != NULL;
+}
+
+void log_set_output(log_output_t output) {
+    output_mode = output;
+}
+
+log_output_t log_get_output(void) {
+    return output_mode;
+}
+
+// Total records dropped on both cores since boot
+uint32_t log_dropped_count(void) {
+    return rings[0].dropped + rings[1].dropped;
+}
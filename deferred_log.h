@@ -0,0 +1,41 @@
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "log_messages.h"
+
+// Deferred logger for hot paths (IRQ handlers, packet processing, watchdog).
+// A call stores a message id, a timestamp and raw arguments in a ring owned by
+// the calling core; nothing is formatted and nothing blocks. log_drain() runs
+// in the Core 0 main loop and formats (or forwards) records in the background.
+// When a ring is full the record is dropped and counted.
+#define LOG_RING_SIZE 64   // Records per core (power of two)
+#define LOG_MAX_ARGS 3
+
+typedef enum {
+    LOG_OUTPUT_TEXT = 0,   // Format on the device with printf
+    LOG_OUTPUT_BINARY,     // Send raw records as control frames (tools/log_decode.py)
+} log_output_t;
+
+typedef struct {
+    uint32_t timestamp_us;
+    uint16_t id;
+    uint8_t nargs;
+    uint8_t core;
+    uint32_t args[LOG_MAX_ARGS];
+} log_record_t;
+
+#define LOG0(id)          log_write((id), 0, 0, 0, 0)
+#define LOG1(id, a)       log_write((id), 1, (a), 0, 0)
+#define LOG2(id, a, b)    log_write((id), 2, (a), (b), 0)
+#define LOG3(id, a, b, c) log_write((id), 3, (a), (b), (c))
+
+// Function prototypes
+void log_write(uint16_t id, uint8_t nargs, uint32_t a0, uint32_t a1, uint32_t a2);
+bool log_drain(void);
+void log_set_output(log_output_t output);
+log_output_t log_get_output(void);
+uint32_t log_dropped_count(void);
+
+#endif // DEFERRED_LOG_H
@@ -0,0 +1,459 @@
+#include "flash_history.h"
+#include "pico/stdlib.h"
+#include "pico/mutex.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+
+#define HISTORY_MAGIC 0x54534948  // "HIST"
+#define HISTORY_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_HISTORY_SIZE)
+#define HISTORY_PAGE_SIZE 256     // Flash program granularity
+
+// Records. Every sector starts with a keyframe so it decodes on its own.
+#define REC_KEY   0x01  // [u32 time_ms][raw bins]
+#define REC_DELTA 0x02  // [u8 dt_ms][tokens until all bins are covered]
+#define REC_END   0xFF  // Erased flash
+
+// Delta tokens (difference to the previous frame, per bin)
+#define TOKEN_RUN_MAX  0x7F  // 0x00-0x7F: 1-128 unchanged bins
+#define TOKEN_DELTA    0x80  // 0x80-0xFE: zigzag-coded change 0-126
+#define TOKEN_ABSOLUTE 0xFF  // Followed by the raw bin value
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;            // Sector sequence number, +1 per sector written
+    uint16_t boot_id;
+    uint16_t num_bins;
+    uint32_t first_time_ms;  // ms since boot of the first frame
+    uint32_t last_time_ms;
+    uint32_t frame_count;
+    uint32_t data_bytes;
+    uint32_t check;          // FNV-1a of the fields above
+} history_header_t;
+
+#define DATA_OFFSET sizeof(history_header_t)
+#define KEY_RECORD_BYTES(n) (5 + (n))
+#define MAX_RECORD_BYTES (2 + 2 * FLASH_HISTORY_MAX_BINS)
+
+// Sector buffers: filled on Core 0, written to flash on Core 1
+typedef enum {
+    BUF_FREE = 0,
+    BUF_FILLING,
+    BUF_READY,
+    BUF_WRITING,
+} buf_state_t;
+
+static uint8_t sector_buf[2][FLASH_HISTORY_SECTOR_SIZE];
+static volatile buf_state_t buf_state[2];
+static volatile uint32_t buf_ticket[2];  // Close order, so sectors are written in sequence
+static uint32_t close_count = 0;
+
+static const flash_history_backend_t* backend = NULL;
+static int num_bins = 0;
+static volatile bool history_enabled = FLASH_HISTORY_DEFAULT;
+
+// Encoder state (Core 0)
+static int fill_buf = -1;
+static uint32_t fill_pos;
+static uint32_t fill_frames;
+static uint32_t fill_first_time;
+static uint32_t prev_time;
+static uint8_t prev_bins[FLASH_HISTORY_MAX_BINS];
+
+// Ring state (written by Core 1 under flash_mutex)
+static mutex_t flash_mutex;
+static volatile uint32_t next_sector = 0;
+static volatile uint32_t next_seq = 1;
+static volatile uint32_t sectors_used = 0;
+static volatile bool sector_writing = false;  // Core 1 is inside flash_history_task()
+static flash_history_stats_t stats;
+
+// Reader state (Core 0)
+typedef struct {
+    bool active;
+    uint32_t seq;            // Sector being read
+    uint32_t pos;
+    uint32_t frames_left;
+    uint16_t boot_id;
+    uint32_t time_ms;
+    uint64_t target;         // Skip frames before this (boot << 32 | time)
+    uint8_t bins[FLASH_HISTORY_MAX_BINS];
+} history_reader_t;
+
+static history_reader_t reader;
+
+static uint32_t header_check(const history_header_t* h) {
+    const uint8_t* p = (const uint8_t*)h;
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < offsetof(history_header_t, check); i++) {
+        hash = (hash ^ p[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static bool header_valid(const history_header_t* h) {
+    return h->magic == HISTORY_MAGIC && h->check == header_check(h);
+}
+
+// On-chip flash backend. All code runs from RAM, so only this core's
+// interrupts are masked; Core 0 keeps receiving while the flash is busy.
+static void onchip_erase_sector(uint32_t offset) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    flash_range_erase(HISTORY_OFFSET + offset, FLASH_HISTORY_SECTOR_SIZE);
+    restore_interrupts(irq_state);
+}
+
+static void onchip_program(uint32_t offset, const uint8_t* data, uint32_t len) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    flash_range_program(HISTORY_OFFSET + offset, data, len);
+    restore_interrupts(irq_state);
+}
+
+static const uint8_t* onchip_map(uint32_t offset) {
+    return (const uint8_t*)(uintptr_t)(XIP_BASE + HISTORY_OFFSET + offset);
+}
+
+static const flash_history_backend_t onchip_backend = {
+    .erase_sector = onchip_erase_sector,
+    .program = onchip_program,
+    .map = onchip_map,
+};
+
+static inline const history_header_t* sector_header(uint32_t sector) {
+    return (const history_header_t*)backend->map(sector * FLASH_HISTORY_SECTOR_SIZE);
+}
+
+// Physical sector holding a sequence number that is still in the ring
+static inline uint32_t sector_of_seq(uint32_t seq) {
+    return (next_sector + FLASH_HISTORY_SECTORS - (next_seq - seq)) % FLASH_HISTORY_SECTORS;
+}
+
+static inline uint64_t frame_key(uint16_t boot_id, uint32_t time_ms) {
+    return ((uint64_t)boot_id << 32) | time_ms;
+}
+
+// Find the newest sector and continue the ring after it
+void flash_history_init(const flash_history_backend_t* custom_backend, int bins) {
+    backend = (custom_backend != NULL) ? custom_backend : &onchip_backend;
+    num_bins = (bins > FLASH_HISTORY_MAX_BINS) ? FLASH_HISTORY_MAX_BINS : bins;
+    mutex_init(&flash_mutex);
+    memset(&stats, 0, sizeof(stats));
+    fill_buf = -1;
+    buf_state[0] = buf_state[1] = BUF_FREE;
+    close_count = 0;
+    reader.active = false;
+    next_sector = 0;
+    next_seq = 1;
+
+    int newest = -1;
+    uint32_t newest_seq = 0;
+    uint16_t max_boot = 0;
+    for (uint32_t s = 0; s < FLASH_HISTORY_SECTORS; s++) {
+        const history_header_t* h = sector_header(s);
+        if (!header_valid(h)) continue;
+        if (newest < 0 || h->seq > newest_seq) {
+            newest = s;
+            newest_seq = h->seq;
+        }
+        if (h->boot_id > max_boot) max_boot = h->boot_id;
+    }
+
+    sectors_used = 0;
+    if (newest >= 0) {
+        // The ring is contiguous backwards from the newest sector
+        for (uint32_t i = 0; i < FLASH_HISTORY_SECTORS; i++) {
+            const history_header_t* h = sector_header((newest + FLASH_HISTORY_SECTORS - i) % FLASH_HISTORY_SECTORS);
+            if (!header_valid(h) || h->seq != newest_seq - i) break;
+            sectors_used++;
+        }
+        next_sector = (newest + 1) % FLASH_HISTORY_SECTORS;
+        next_seq = newest_seq + 1;
+    }
+    stats.boot_id = max_boot + 1;
+
+    printf("History: %u/%u sectors used (%u KB), boot %u\n",
+           sectors_used, FLASH_HISTORY_SECTORS, sectors_used * FLASH_HISTORY_SECTOR_SIZE / 1024, stats.boot_id);
+}
+
+void flash_history_set_enabled(bool enabled) {
+    history_enabled = enabled;
+}
+
+bool flash_history_enabled(void) {
+    return history_enabled;
+}
+
+static bool start_buffer(uint32_t time_ms) {
+    for (int b = 0; b < 2; b++) {
+        if (buf_state[b] == BUF_FREE) {
+            buf_state[b] = BUF_FILLING;
+            fill_buf = b;
+            fill_pos = DATA_OFFSET;
+            fill_frames = 0;
+            fill_first_time = time_ms;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Finish the header and hand the buffer to Core 1 (seq and check are set there)
+static void close_buffer(void) {
+    uint8_t* buf = sector_buf[fill_buf];
+    history_header_t* h = (history_header_t*)buf;
+    h->magic = HISTORY_MAGIC;
+    h->boot_id = stats.boot_id;
+    h->num_bins = num_bins;
+    h->first_time_ms = fill_first_time;
+    h->last_time_ms = prev_time;
+    h->frame_count = fill_frames;
+    h->data_bytes = fill_pos - DATA_OFFSET;
+    memset(buf + fill_pos, REC_END, FLASH_HISTORY_SECTOR_SIZE - fill_pos);
+
+    buf_ticket[fill_buf] = ++close_count;
+    __dmb();
+    buf_state[fill_buf] = BUF_READY;
+    fill_buf = -1;
+}
+
+static int encode_key(uint32_t time_ms, const uint8_t* bins, uint8_t* out) {
+    out[0] = REC_KEY;
+    memcpy(&out[1], &time_ms, 4);
+    memcpy(&out[5], bins, num_bins);
+    return KEY_RECORD_BYTES(num_bins);
+}
+
+static int encode_delta(uint8_t dt_ms, const uint8_t* bins, uint8_t* out) {
+    int k = 0;
+    out[k++] = REC_DELTA;
+    out[k++] = dt_ms;
+
+    int i = 0;
+    while (i < num_bins) {
+        if (bins[i] == prev_bins[i]) {
+            int run = 0;
+            while (i < num_bins && bins[i] == prev_bins[i] && run <= TOKEN_RUN_MAX) {
+                run++;
+                i++;
+            }
+            out[k++] = run - 1;
+        } else {
+            int d = bins[i] - prev_bins[i];
+            int zz = (d < 0) ? -2 * d - 1 : 2 * d;
+            if (zz < TOKEN_ABSOLUTE - TOKEN_DELTA) {
+                out[k++] = TOKEN_DELTA + zz;
+            } else {
+                out[k++] = TOKEN_ABSOLUTE;
+                out[k++] = bins[i];
+            }
+            i++;
+        }
+    }
+    return k;
+}
+
+// Compress one frame into the current sector buffer (Core 0, per packet)
+void flash_history_append(uint32_t time_ms, const uint8_t* bins) {
+    if (!history_enabled || backend == NULL) return;
+
+    if (fill_buf < 0 && !start_buffer(time_ms)) {
+        stats.frames_dropped++;  // Core 1 has not written the previous sectors yet
+        return;
+    }
+
+    uint8_t record[MAX_RECORD_BYTES];
+    int len;
+    uint32_t dt = time_ms - prev_time;
+    if (fill_frames > 0 && dt <= 0xFF) {
+        len = encode_delta(dt, bins, record);
+        if (len > KEY_RECORD_BYTES(num_bins)) len = encode_key(time_ms, bins, record);
+    } else {
+        len = encode_key(time_ms, bins, record);
+    }
+
+    if (fill_pos + len > FLASH_HISTORY_SECTOR_SIZE) {
+        close_buffer();
+        if (!start_buffer(time_ms)) {
+            stats.frames_dropped++;
+            return;
+        }
+        len = encode_key(time_ms, bins, record);
+    }
+
+    memcpy(&sector_buf[fill_buf][fill_pos], record, len);
+    fill_pos += len;
+    fill_frames++;
+    prev_time = time_ms;
+    memcpy(prev_bins, bins, num_bins);
+}
+
+// Write the oldest full sector buffer to flash (Core 1, between frames).
+// Takes one erase + program, ~50 ms; returns true if a sector was written.
+bool flash_history_task(void) {
+    int b = -1;
+    for (int i = 0; i < 2; i++) {
+        if (buf_state[i] == BUF_READY && (b < 0 || buf_ticket[i] < buf_ticket[b])) b = i;
+    }
+    if (b < 0) return false;
+    sector_writing = true;
+    buf_state[b] = BUF_WRITING;
+    __dmb();
+
+    uint8_t* buf = sector_buf[b];
+    history_header_t* h = (history_header_t*)buf;
+    uint32_t start_us = time_us_32();
+
+    mutex_enter_blocking(&flash_mutex);
+    h->seq = next_seq;
+    h->check = header_check(h);
+    uint32_t offset = next_sector * FLASH_HISTORY_SECTOR_SIZE;
+    backend->erase_sector(offset);
+    // Header page last: a valid header means the whole sector was programmed
+    backend->program(offset + HISTORY_PAGE_SIZE, buf + HISTORY_PAGE_SIZE,
+                     FLASH_HISTORY_SECTOR_SIZE - HISTORY_PAGE_SIZE);
+    backend->program(offset, buf, HISTORY_PAGE_SIZE);
+    next_sector = (next_sector + 1) % FLASH_HISTORY_SECTORS;
+    next_seq++;
+    if (sectors_used < FLASH_HISTORY_SECTORS) sectors_used++;
+    mutex_exit(&flash_mutex);
+
+    uint32_t write_us = time_us_32() - start_us;
+    if (write_us > stats.write_us_max) stats.write_us_max = write_us;
+    stats.sectors_written++;
+    stats.frames_written += h->frame_count;
+    stats.raw_bytes += h->frame_count * (4 + num_bins);
+    stats.encoded_bytes += h->data_bytes;
+
+    buf_state[b] = BUF_FREE;
+    __dmb();
+    sector_writing = false;
+    return true;
+}
+
+// True while Core 1 writes a sector. Resetting Core 1 in the middle of an
+// erase or program would leave XIP off, and Core 0 reads the ring through
+// XIP, so the display watchdog waits for this to clear.
+bool flash_history_writing(void) {
+    return sector_writing;
+}
+
+// Core 1 was reset (display watchdog) between writes: release the lock and
+// retry a sector it had claimed
+void flash_history_recover(void) {
+    sector_writing = false;
+    mutex_init(&flash_mutex);
+    for (int b = 0; b < 2; b++) {
+        if (buf_state[b] == BUF_WRITING) buf_state[b] = BUF_READY;
+    }
+}
+
+void flash_history_get_stats(flash_history_stats_t* out) {
+    *out = stats;
+    out->sectors_used = sectors_used;
+    out->laps = (next_seq - 1) / FLASH_HISTORY_SECTORS;
+}
+
+// Open a sector for reading; caller holds flash_mutex
+static bool reader_open(uint32_t seq) {
+    if (seq < next_seq - sectors_used || seq >= next_seq) return false;
+    const history_header_t* h = sector_header(sector_of_seq(seq));
+    if (!header_valid(h) || h->seq != seq) return false;
+
+    reader.seq = seq;
+    reader.pos = DATA_OFFSET;
+    reader.frames_left = h->frame_count;
+    reader.boot_id = h->boot_id;
+    return true;
+}
+
+int flash_history_seek(uint16_t boot_id, uint32_t time_ms) {
+    reader.active = false;
+    if (backend == NULL) return 0;
+    if (!mutex_try_enter(&flash_mutex, NULL)) return -1;
+
+    // Binary search: last sector whose first frame is at or before the target
+    uint64_t target = frame_key(boot_id, time_ms);
+    uint32_t oldest = next_seq - sectors_used;
+    uint32_t lo = 0;
+    uint32_t hi = sectors_used;
+    while (hi - lo > 1) {
+        uint32_t mid = (lo + hi) / 2;
+        const history_header_t* h = sector_header(sector_of_seq(oldest + mid));
+        if (frame_key(h->boot_id, h->first_time_ms) <= target) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+
+    reader.target = target;
+    reader.active = sectors_used > 0 && reader_open(oldest + lo);
+    mutex_exit(&flash_mutex);
+    return reader.active ? 1 : 0;
+}
+
+// Decode the record at the reader position; false if the data is corrupt
+static bool reader_decode(const uint8_t* sector) {
+    const uint8_t* p = sector + reader.pos;
+    uint32_t avail = FLASH_HISTORY_SECTOR_SIZE - reader.pos;
+
+    if (p[0] == REC_KEY && avail >= (uint32_t)KEY_RECORD_BYTES(num_bins)) {
+        memcpy(&reader.time_ms, &p[1], 4);
+        memcpy(reader.bins, &p[5], num_bins);
+        reader.pos += KEY_RECORD_BYTES(num_bins);
+        return true;
+    }
+    if (p[0] != REC_DELTA || avail < 2) return false;
+
+    reader.time_ms += p[1];
+    uint32_t k = 2;
+    int i = 0;
+    while (i < num_bins) {
+        if (k >= avail) return false;
+        uint8_t t = p[k++];
+        if (t <= TOKEN_RUN_MAX) {
+            i += t + 1;
+        } else if (t == TOKEN_ABSOLUTE) {
+            if (k >= avail) return false;
+            reader.bins[i++] = p[k++];
+        } else {
+            int zz = t - TOKEN_DELTA;
+            reader.bins[i++] += (zz & 1) ? -(zz + 1) / 2 : zz / 2;
+        }
+    }
+    reader.pos += k;
+    return true;
+}
+
+int flash_history_read(flash_history_frame_t* frame) {
+    if (!reader.active) return 0;
+    if (!mutex_try_enter(&flash_mutex, NULL)) return -1;
+
+    int result = 0;
+    while (true) {
+        // The writer may have reused the sector since the last call
+        const history_header_t* h = sector_header(sector_of_seq(reader.seq));
+        if (reader.seq < next_seq - sectors_used || !header_valid(h) || h->seq != reader.seq) break;
+
+        if (reader.frames_left == 0) {
+            if (!reader_open(reader.seq + 1)) break;
+            continue;
+        }
+        if (!reader_decode((const uint8_t*)h)) break;
+        reader.frames_left--;
+
+        if (frame_key(reader.boot_id, reader.time_ms) >= reader.target) {
+            frame->boot_id = reader.boot_id;
+            frame->time_ms = reader.time_ms;
+            memcpy(frame->bins, reader.bins, num_bins);
+            result = 1;
+            break;
+        }
+    }
+
+    if (result == 0) reader.active = false;
+    mutex_exit(&flash_mutex);
+    return result;
+}
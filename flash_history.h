@@ -0,0 +1,66 @@
+#ifndef FLASH_HISTORY_H
+#define FLASH_HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Long-term spectrogram history in a ring of flash sectors at the end of flash.
+//
+// Core 0 compresses every received frame into a RAM sector buffer (keyframe
+// at the start of each sector, then per-bin deltas with zero-run coding).
+// Full buffers are written by flash_history_task() on Core 1; the firmware
+// runs from RAM (copy_to_ram), so erasing and programming never stalls the
+// I2C IRQ or packet processing on Core 0. Writing the sectors round-robin
+// spreads erases evenly over the region (wear leveling). Every sector carries
+// its sequence number, boot id and first timestamp, so the log is indexed by
+// (boot, time) with a binary search over sector headers.
+#define FLASH_HISTORY_SIZE (1024 * 1024)  // Last 1 MB of the 2 MB flash
+#define FLASH_HISTORY_SECTOR_SIZE 4096
+#define FLASH_HISTORY_SECTORS (FLASH_HISTORY_SIZE / FLASH_HISTORY_SECTOR_SIZE)
+#define FLASH_HISTORY_MAX_BINS 64
+#define FLASH_HISTORY_DEFAULT true
+
+// Storage backend (erase/program one region, memory-mapped reads). NULL
+// selects the on-chip flash; a RAM emulator can be passed for host testing.
+typedef struct {
+    void (*erase_sector)(uint32_t offset);
+    void (*program)(uint32_t offset, const uint8_t* data, uint32_t len);
+    const uint8_t* (*map)(uint32_t offset);
+} flash_history_backend_t;
+
+// One decoded frame
+typedef struct {
+    uint16_t boot_id;
+    uint32_t time_ms;
+    uint8_t bins[FLASH_HISTORY_MAX_BINS];
+} flash_history_frame_t;
+
+typedef struct {
+    uint32_t sectors_used;
+    uint32_t sectors_written;   // Since boot
+    uint32_t frames_written;    // Frames handed to flash since boot
+    uint32_t frames_dropped;    // Both sector buffers busy
+    uint32_t raw_bytes;         // Uncompressed size of the written frames
+    uint32_t encoded_bytes;     // Compressed size of the written frames
+    uint32_t write_us_max;      // Longest erase + program
+    uint32_t laps;              // Full passes over the ring (erase cycles per sector)
+    uint16_t boot_id;
+} flash_history_stats_t;
+
+// Function prototypes
+void flash_history_init(const flash_history_backend_t* backend, int num_bins);
+void flash_history_set_enabled(bool enabled);
+bool flash_history_enabled(void);
+void flash_history_append(uint32_t time_ms, const uint8_t* bins);
+bool flash_history_task(void);
+bool flash_history_writing(void);
+void flash_history_recover(void);
+void flash_history_get_stats(flash_history_stats_t* stats);
+
+// Readout (Core 0): seek to the first frame at or after (boot_id, time_ms),
+// then read frames one at a time. Both return -1 while Core 1 is writing
+// (retry later), 0 if there is nothing (more) to read and 1 on success.
+int flash_history_seek(uint16_t boot_id, uint32_t time_ms);
+int flash_history_read(flash_history_frame_t* frame);
+
+#endif // FLASH_HISTORY_H
@@ -0,0 +1,112 @@
+#include "history_pyramid.h"
+#include <stdio.h>
+#include <string.h>
+
+// Level n is stored at index n - 1. Rows are circular like the live buffer:
+// head points at the slot the next row goes to.
+static uint8_t level_rows[PYRAMID_LEVELS][PYRAMID_DEPTH][STORE_ROW_BYTES];
+static volatile int level_head[PYRAMID_LEVELS];
+
+// Rows produced per level since reset; [0] counts received frames
+static uint32_t level_count[PYRAMID_LEVELS + 1];
+
+// First row of an incomplete pair, per input level (0 = live)
+static uint8_t pending[PYRAMID_LEVELS][STORE_ROW_BYTES];
+
+static inline uint8_t pool_codes(uint8_t a, uint8_t b) {
+#if PYRAMID_POOL_MAX
+    return (a > b) ? a : b;
+#else
+    return (a + b + 1) >> 1;
+#endif
+}
+
+// Pool two stored rows, a byte (one or two codes) at a time
+static inline void pool_rows(const uint8_t* a, const uint8_t* b, uint8_t* out) {
+    for (int i = 0; i < STORE_ROW_BYTES; i++) {
+#if SPECTRO_STORE_BITS == 4
+        out[i] = pool_codes(a[i] & 0x0F, b[i] & 0x0F) | (pool_codes(a[i] >> 4, b[i] >> 4) << 4);
+#else
+        out[i] = pool_codes(a[i], b[i]);
+#endif
+    }
+}
+
+void history_pyramid_reset(void) {
+    memset(level_rows, 0, sizeof(level_rows));
+    memset(level_count, 0, sizeof(level_count));
+    for (int l = 0; l < PYRAMID_LEVELS; l++) {
+        level_head[l] = 0;
+    }
+}
+
+// Add one received frame, as stored in the live buffer (Core 0, per packet).
+// A row completing level n feeds level n + 1, so at most PYRAMID_LEVELS
+// rows are pooled per call.
+void history_pyramid_push(const uint8_t* row) {
+
+    for (int l = 0; l < PYRAMID_LEVELS; l++) {
+        if ((level_count[l]++ & 1) == 0) {
+            memcpy(pending[l], row, STORE_ROW_BYTES);  // First of a pair
+            return;
+        }
+
+        int head = level_head[l];
+        uint8_t* out = level_rows[l][head];
+        pool_rows(pending[l], row, out);
+        level_head[l] = (head + 1) % PYRAMID_DEPTH;
+        row = out;
+    }
+    level_count[PYRAMID_LEVELS]++;
+}
+
+// Row storage of a level (1..PYRAMID_LEVELS), indexed like the live buffer
+pyramid_rows_t history_pyramid_rows(int level) {
+    return (pyramid_rows_t)level_rows[level - 1];
+}
+
+int history_pyramid_head(int level) {
+    return level_head[level - 1];
+}
+
+// Rows produced by a level since reset (level 0 = received frames)
+uint32_t history_pyramid_count(int level) {
+    return level_count[level];
+}
+
+static const uint8_t* level_row(int level, int age) {
+    int index = (level_head[level - 1] - 1 - age + PYRAMID_DEPTH) % PYRAMID_DEPTH;
+    return level_rows[level - 1][index];
+}
+
+uint32_t history_pyramid_check(const uint8_t* (*level0_row)(int age), int level0_depth) {
+    uint32_t total_mismatches = 0;
+
+    for (int level = 1; level <= PYRAMID_LEVELS; level++) {
+        uint32_t count = level_count[level];
+        uint32_t src_count = level_count[level - 1];
+        uint32_t src_depth = (level == 1) ? level0_depth : PYRAMID_DEPTH;
+        uint32_t rows = (count < PYRAMID_DEPTH) ? count : PYRAMID_DEPTH;
+        uint32_t checked = 0;
+        uint32_t mismatches = 0;
+
+        for (uint32_t age = 0; age < rows; age++) {
+            // Row number n of this level pools source rows 2n and 2n + 1
+            uint32_t n = count - 1 - age;
+            uint32_t newer_age = src_count - 1 - (2 * n + 1);
+            if (newer_age + 1 >= src_depth) break;  // Older source rows are overwritten
+
+            const uint8_t* newer = (level == 1) ? level0_row(newer_age) : level_row(level - 1, newer_age);
+            const uint8_t* older = (level == 1) ? level0_row(newer_age + 1) : level_row(level - 1, newer_age + 1);
+            uint8_t expected[STORE_ROW_BYTES];
+            pool_rows(older, newer, expected);
+            if (memcmp(expected, level_row(level, age), STORE_ROW_BYTES) != 0) mismatches++;
+            checked++;
+        }
+
+        printf("PYRAMID level %d (%ux): %u rows, %u checked, %u mismatches\n",
+               level, 1u << level, count, checked, mismatches);
+        total_mismatches += mismatches;
+    }
+    return total_mismatches;
+}
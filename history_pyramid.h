@@ -0,0 +1,48 @@
+#ifndef HISTORY_PYRAMID_H
+#define HISTORY_PYRAMID_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "spectro_geometry.h"
+#include "spectro_store.h"
+
+// Multi-resolution spectrogram history (mipmap levels). Level n holds rows
+// pooled over 2^n received frames, so one screen of rows covers 2^n times
+// the time span of the live buffer. Levels are updated incrementally as
+// frames arrive: every second row of a level completes one row of the next,
+// which costs two row operations per frame on average. Switching the time
+// scale only changes which level the renderer reads.
+//
+// Rows use the live buffer's storage format (spectro_store.h) and pooling
+// works on codes, so levels need no conversion to be drawn.
+//
+// Memory is fixed at compile time:
+//   PYRAMID_LEVELS * PYRAMID_DEPTH * STORE_ROW_BYTES
+//   = 6 * 100 * 40 = 24000 bytes at the default depth and 8-bit storage
+//   plus one pending row per level
+// At 60 frames/s and depth 100 one screen spans 1.7 s (live), 3.3 s, 6.7 s,
+// 13 s, 27 s, 53 s and 107 s (level 6).
+#define PYRAMID_LEVELS 6             // Levels 1..6: 2x .. 64x coarser than the live buffer
+#define PYRAMID_DEPTH SPECTRO_DEPTH  // Rows per level (one screen, same as the live buffer)
+
+// Pooling of two rows into one: 1 = max (keeps short peaks visible), 0 = mean
+#ifndef PYRAMID_POOL_MAX
+#define PYRAMID_POOL_MAX 1
+#endif
+
+typedef const uint8_t (*pyramid_rows_t)[STORE_ROW_BYTES];
+
+// Function prototypes
+void history_pyramid_reset(void);
+void history_pyramid_push(const uint8_t* row);
+pyramid_rows_t history_pyramid_rows(int level);
+int history_pyramid_head(int level);
+uint32_t history_pyramid_count(int level);
+
+// Recompute every level row whose source rows are still held one level
+// below (live buffer for level 1) and compare. level0_row(age) returns a
+// live row by age (0 = newest), level0_depth how many of them exist.
+// Prints one line per level; returns the total number of mismatches.
+uint32_t history_pyramid_check(const uint8_t* (*level0_row)(int age), int level0_depth);
+
+#endif // HISTORY_PYRAMID_H
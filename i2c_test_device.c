@@ -1,12 +1,25 @@
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
 #include "hardware/gpio.h"
 #include "hardware/irq.h"
 #include "hardware/resets.h"
+#include "hardware/clocks.h"
 #include "pico/multicore.h"
 #include "st7796_driver.h"
+#include "touch_driver.h"
+#include "spectro_geometry.h"
+#include "bin_stats.h"
+#include "control_protocol.h"
+#include "deferred_log.h"
+#include "stress_stats.h"
+#include "flash_history.h"
+#include "history_pyramid.h"
+#include "speech_features.h"
+#include "spectro_store.h"
+#include "spectro_render.h"
 
 // I2C Configuration - Using I2C0 on GPIO 20 (SDA) and GPIO 21 (SCL)
 #define I2C_PORT i2c0
@@ -15,34 +28,56 @@
 #define I2C_BASE_ADDR 0x60
 #define I2C_BAUDRATE 400000
 
-// Debug output control
+// Debug output control (default; changeable at runtime over USB)
 #define DEBUG_VERBOSE 0  // Set to 1 for detailed output, 0 for minimal
 
 // Button pins for address selection
 #define BTN_ADDR_UP 14    // Increment I2C address
 #define BTN_ADDR_DOWN 15  // Decrement I2C address
 
-// Touch screen I2C (reserved for future use)
-#define TOUCH_I2C_SDA 8
-#define TOUCH_I2C_SCL 9
-#define TOUCH_RST_PIN 10
-#define TOUCH_INT_PIN 11
+// Touch screen (FT6336 on GPIO 8-11) is handled in touch_driver.c
 
 // Packet format from master
 #define PACKET_HEADER 0xAA
 #define PACKET_SIZE 41  // 1 header + 40 bins × 1 byte
-#define NUM_FREQ_BINS 40
 
-// Spectrogram buffer: 100 time samples × 40 frequency bins
-// Using circular buffer with head pointer for O(1) insertion
-#define SPECTROGRAM_DEPTH 100
-uint8_t spectrogram_buffer[SPECTROGRAM_DEPTH][NUM_FREQ_BINS] = {0};
-volatile int spectrogram_head = 0;  // Points to newest data row (circular index)
+// Channel packets from masters with several beams: header, channel, sequence
+// number, 40 bins. Plain packets are channel 0. Every channel has its own
+// history ring; channel 0 also feeds the statistics, speech features, time
+// scale pyramid and flash history. Ring memory scales with SPECTRO_CHANNELS.
+#define CHANNEL_PACKET_HEADER 0xAB
+#define CHANNEL_PACKET_SIZE 43  // 1 header + channel + sequence + 40 bins
+#define RX_BUFFER_SIZE CHANNEL_PACKET_SIZE
+#ifndef SPECTRO_CHANNELS
+#define SPECTRO_CHANNELS 1      // History rings and split-screen panes (1-4)
+#endif
+#if SPECTRO_CHANNELS < 1 || SPECTRO_CHANNELS > 4
+#error "SPECTRO_CHANNELS must be 1 to 4"
+#endif
+
+// Spectrogram buffer: time samples (depth from the geometry profile) × 40
+// frequency bins, stored as 8-bit or 4-bit packed codes (spectro_store.h).
+// Using circular buffer with head pointer for O(1) insertion.
+// The displayed depth can be reduced at runtime; rows are then stretched.
+#define SPECTROGRAM_DEPTH_MIN 8
+uint8_t spectrogram_buffer[SPECTRO_CHANNELS][SPECTROGRAM_DEPTH][STORE_ROW_BYTES] = {0};
+volatile int spectrogram_head[SPECTRO_CHANNELS] = {0};  // Slot of the next row, per channel (circular index)
+
+// Time scale: level 0 shows the live buffer, level n a history pyramid level
+// with 2^n frames pooled per row. Levels share the live buffer's row layout.
+#if PYRAMID_DEPTH != SPECTROGRAM_DEPTH || STORE_BINS != NUM_FREQ_BINS
+#error "History pyramid levels must match the spectrogram buffer"
+#endif
+#define TIME_LEVEL_DEFAULT 0
+int view_time_level = TIME_LEVEL_DEFAULT;  // Latched by Core 1
+pyramid_rows_t view_source = (pyramid_rows_t)spectrogram_buffer[0];  // Rows of the selected level
+uint32_t packet_rate = 0;  // pkt/s, for the time span label
 
 // Receive buffer
-uint8_t rx_buffer[PACKET_SIZE];
+uint8_t rx_buffer[RX_BUFFER_SIZE];
 volatile int rx_index = 0;
 volatile bool packet_ready = false;
+volatile uint32_t packet_ready_us = 0;  // When the IRQ completed the packet (consumer lag)
 
 // Current I2C address (changeable via buttons)
 volatile uint8_t current_i2c_address = I2C_BASE_ADDR;
@@ -58,15 +93,181 @@ volatile bool core1_paused = false;
 // Core 1 watchdog heartbeat (ms)
 volatile uint32_t core1_last_beat_ms = 0;
 #define CORE1_WATCHDOG_MS 5000
+#define CORE1_FLASH_WAIT_MS 1000  // Longest sector write the reset waits for
+
+// Staged display recovery: a soft resync keeps the panel's frame memory and
+// skips the reset sleeps; the full reset is only used when the panel does not
+// read back its settings afterwards. Either way Core 1 replays the header,
+// statistics and history from RAM in its first frame. Recovery time runs
+// from the watchdog firing to the end of that frame.
+#define RECOVERY_SOFT 1
+#define RECOVERY_HARD 2
+
+bool display_readback = false;           // Panel answers register reads (checked at boot)
+volatile uint32_t recovery_soft_count = 0;
+volatile uint32_t recovery_hard_count = 0;
+volatile uint32_t recovery_failed_count = 0;  // Readback still wrong after the full reset
+volatile bool recovery_replay_pending = false;
+uint32_t recovery_start_us = 0;
+uint8_t recovery_stage = 0;
+uint32_t recovery_last_us = 0;
+uint32_t recovery_max_us = 0;
 
-// Display update rate (ms)
+// Display update rate (ms, default; changeable at runtime over USB)
 #define DISPLAY_UPDATE_MS 2000
+#define DISPLAY_UPDATE_MS_MIN 20
+#define DISPLAY_UPDATE_MS_MAX 60000
+
+// Color scaling defaults
+#define GAIN_FLOOR_DEFAULT 16  // Minimum max_value used for color scaling
+
+// I2C address range accepted over USB (buttons stay within 0x60-0x67)
+#define I2C_ADDR_MIN 0x08
+#define I2C_ADDR_MAX 0x77
+
+// Spectrogram layout, tiles, view tables, palette and composition bands
+// are in spectro_render.h
+#define VIEW_REDRAW_MIN_MS 50  // Throttle redraws while dragging
+
+// Speech features per received frame, stored next to the spectrogram rows
+// (same circular index) and drawn as a strip beside the waterfall. Values
+// are scaled to bytes for display: energy in 1/4 dB, centroid over the bin
+// range, flatness in 1/256.
+typedef struct {
+    uint8_t energy;
+    uint8_t centroid;
+    uint8_t flatness;
+    uint8_t voice;
+} feature_row_t;
+
+feature_row_t feature_rows[SPECTROGRAM_DEPTH];
+uint32_t feature_strip_hash[TILES_Y];
+uint16_t feature_strip_pixels[FEATURE_STRIP_W * TILE_H];
+
+// Scroll mode (landscape): a horizontal waterfall instead of the row layout.
+// A history row is one screen column, and in landscape one screen column is
+// one frame-memory line of the panel, so the row-major history buffers are
+// already column-major for the panel: new rows go out as a single window
+// (st7796_write_lines) and the older columns are moved by the panel's
+// hardware scroll instead of being redrawn. Zoom, pan, warp and the
+// interpolating renderers apply to the row layout only.
+#define SCROLL_MODE_DEFAULT false
+#define SCROLL_BATCH_ROWS 4  // Rows composed per window write
+
+bool scroll_mode = SCROLL_MODE_DEFAULT;  // Latched by Core 1
+bool scroll_valid = false;  // Panel holds the scroll layout for the current settings
+int scroll_start = 0;       // Frame-memory line at the left edge (oldest column)
+int scroll_head = 0;        // Source head when the newest column was drawn
+uint32_t scroll_count = 0;  // Rows of the displayed level at that time
+uint32_t scroll_bytes_per_row = 0;
+#if SCROLL_SUPPORTED
+#if SCROLL_BIN_H * NUM_FREQ_BINS != LCD_WIDTH
+#error "Scroll mode bins must fill a panel line"
+#endif
+uint16_t scroll_pixels[SCROLL_BATCH_ROWS * SCROLL_COLUMN_W * LCD_WIDTH];
+#endif
+
+// Split screen: one waterfall pane per channel, stacked in the spectrogram
+// area with the newest row at the top of each pane. All panes share one
+// color scale (the largest code over every pane), one palette lookup and
+// one render pass. A sample row of a pane goes out as one full-width blit
+// composed in tile_pixels, and only rows whose codes or color scale changed
+// since the pane last drew them are sent. Panes show live rows (time
+// scale 1x); zoom, pan, warp and the interpolating renderers apply to the
+// single-channel row layout only.
+#define SPLIT_GAP 2  // Black pixel rows between panes
+
+#if SPECTRO_W * SPECTRO_PIXEL_H > TILE_W * TILE_H
+#error "A split pane row must fit the composition buffer"
+#endif
+
+int split_panes = SPECTRO_CHANNELS;  // Latched by Core 1, 1 = single layout
+bool split_valid = false;   // Panel holds the split layout for the current settings
+int split_rows = 0;         // Sample rows per pane
+int split_head[SPECTRO_CHANNELS];  // Ring heads captured for the frame
+uint32_t split_row_hash[SPECTRO_CHANNELS][SPECTROGRAM_DEPTH];  // Per drawn pane row
+static const uint8_t *split_pane_rows[SPECTROGRAM_DEPTH];  // Row table of the pane being walked
+uint32_t split_rows_sent = 0;
+
+// RAM that grows with each channel: history ring and pane row hashes
+#define CHANNEL_MEMORY_BYTES (sizeof(spectrogram_buffer[0]) + sizeof(split_row_hash[0]))
+
+// Display parameters owned by Core 1. Changes from the control channel go to
+// display_params_requested and are latched at the start of the next frame,
+// so a frame never mixes old and new settings.
+typedef struct {
+    render_mode_t render_mode;
+    freq_warp_t freq_warp;
+    bool interp_time;
+    int spectrogram_depth;
+    int time_level;
+    uint8_t palette;
+    uint8_t gain_floor;
+    bool scroll_mode;
+    int channels;  // Split-screen panes
+} display_params_t;
+
+uint8_t gain_floor = GAIN_FLOOR_DEFAULT;
+
+display_params_t display_params_requested = {
+    RENDER_MODE_DEFAULT, FREQ_WARP_DEFAULT, INTERP_TIME_DEFAULT,
+    SPECTROGRAM_DEPTH, TIME_LEVEL_DEFAULT, PALETTE_DEFAULT, GAIN_FLOOR_DEFAULT,
+    SCROLL_MODE_DEFAULT, SPECTRO_CHANNELS,
+};
+volatile bool display_params_pending = false;
+volatile bool redraw_requested = false;  // Redraw without waiting for the update interval
+
+// Runtime parameters read directly (single word, no latching needed)
+volatile uint32_t display_update_ms = DISPLAY_UPDATE_MS;
+volatile bool debug_verbose = DEBUG_VERBOSE;
+
+// Screenshot readout: rows are composed on Core 0 and sent one per loop pass
+int screenshot_row = -1;  // -1 = idle
+uint8_t screenshot_frame[2 + SPECTRO_W * 2];  // [u16 row][RGB565 pixels]
+
+// Flash history readout: one frame per loop pass, like the screenshot
+int history_frames_left = 0;
+bool history_seek_pending = false;
+uint16_t history_seek_boot = 0;
+uint32_t history_seek_time = 0;
+
+// Partial refresh statistics
+uint32_t display_frames = 0;
+uint32_t tiles_sent_last_frame = 0;
+uint32_t bus_bytes_last_frame = 0;
+uint32_t span_fills_last_frame = 0;
+uint32_t span_blits_last_frame = 0;
+uint32_t render_us_last_frame = 0;
+uint32_t compose_ns_per_pixel = 0;  // Interpolating renderer inner loop cost
+uint32_t dma_wait_us_last_frame = 0;  // Renderer blocked on pixel DMA
+uint32_t compose_busy_pct = 0;        // Share of the frame spent composing (not waiting)
+uint32_t spi_busy_pct = 0;            // Share of the frame the SPI bus was sending
 
 // Performance monitoring
 volatile uint32_t packet_count = 0;
+volatile uint32_t invalid_header_count = 0;
+volatile uint32_t aborted_transfer_count = 0;  // STOP before a full packet
+volatile uint32_t rx_fifo_overflows = 0;       // Bytes lost in the I2C RX FIFO
+volatile uint32_t rx_dropped_bytes = 0;        // Bytes received while a packet was unconsumed
+volatile uint32_t invalid_channel_count = 0;   // Channel packets for a channel without a ring
+
+// Per-channel counters: packets and sequence gaps (Core 0), rate and the
+// cost of the channel's pane in the last frame that drew it (Core 1)
+volatile uint32_t channel_packets[SPECTRO_CHANNELS];
+volatile uint32_t channel_lost[SPECTRO_CHANNELS];
+uint8_t channel_next_seq[SPECTRO_CHANNELS];
+bool channel_seq_valid[SPECTRO_CHANNELS];
+uint32_t channel_rate[SPECTRO_CHANNELS];
+uint32_t channel_last_packets[SPECTRO_CHANNELS];
+uint32_t channel_render_us[SPECTRO_CHANNELS];
+uint32_t channel_bus_bytes[SPECTRO_CHANNELS];
 uint32_t last_packet_count = 0;
 uint32_t last_perf_check_ms = 0;
 
+// Verbose mode logs the first few I2C interrupts after it is enabled
+#define IRQ_DEBUG_CAPTURE 5
+volatile uint32_t irq_debug_count = 0;
+
 // Button debouncing
 uint32_t last_btn_up_time = 0;
 uint32_t last_btn_down_time = 0;
@@ -74,6 +275,7 @@ uint32_t last_btn_down_time = 0;
 
 // Button interrupt handlers
 void gpio_callback(uint gpio, uint32_t events) {
+    (void)events;
     uint32_t now = to_ms_since_boot(get_absolute_time());
     
     if (gpio == BTN_ADDR_UP && (now - last_btn_up_time) > DEBOUNCE_MS) {
@@ -99,14 +301,20 @@ uint8_t read_address_selection(void) {
     return current_i2c_address;
 }
 
+// Expected length of the packet starting with this header byte
+static inline int packet_size(uint8_t header) {
+    return (header == CHANNEL_PACKET_HEADER) ? CHANNEL_PACKET_SIZE : PACKET_SIZE;
+}
+
 // I2C IRQ handler for slave mode
 void i2c1_irq_handler(void) {
-    static uint32_t irq_count = 0;
+    uint32_t entry_us = time_us_32();
+    uint32_t entry_fifo_level = i2c_get_read_available(I2C_PORT);
     uint32_t status = i2c_get_hw(I2C_PORT)->intr_stat;
     
-    // Debug: Print first few interrupts only (if verbose mode enabled)
-    if (DEBUG_VERBOSE && irq_count < 5) {
-        printf("I2C IRQ #%u: status=0x%08X\n", irq_count++, status);
+    // Debug: Log first few interrupts only (if verbose mode enabled)
+    if (debug_verbose && irq_debug_count < IRQ_DEBUG_CAPTURE) {
+        LOG2(LOG_I2C_IRQ_STATUS, irq_debug_count++, status);
     }
     
     // RX FIFO has data
@@ -114,52 +322,145 @@ void i2c1_irq_handler(void) {
         while (i2c_get_read_available(I2C_PORT) > 0) {
             uint8_t byte = i2c_get_hw(I2C_PORT)->data_cmd & 0xFF;
             
-            if (rx_index < PACKET_SIZE) {
+            if (rx_index == 0 || rx_index < packet_size(rx_buffer[0])) {
                 rx_buffer[rx_index++] = byte;
                 
-                if (rx_index == PACKET_SIZE) {
+                if (rx_index == packet_size(rx_buffer[0])) {
                     packet_ready = true;
-                    if (DEBUG_VERBOSE) printf("Packet complete! [%u bytes]\n", PACKET_SIZE);
+                    packet_ready_us = time_us_32();
+                    if (debug_verbose) LOG1(LOG_PACKET_COMPLETE, rx_index);
                 }
+            } else {
+                rx_dropped_bytes++;  // Main loop has not consumed the last packet yet
             }
         }
     }
     
+    // RX FIFO overflow: the IRQ was serviced too late
+    if (status & (1 << 1)) {  // IC_INTR_RX_OVER
+        (void)i2c_get_hw(I2C_PORT)->clr_rx_over;
+        rx_fifo_overflows++;
+    }
+    
     // STOP condition detected
     if (status & (1 << 9)) {  // IC_INTR_STOP_DET
         // Clear stop interrupt
         (void)i2c_get_hw(I2C_PORT)->clr_stop_det;
         
         // If incomplete packet, reset
-        if (rx_index > 0 && rx_index < PACKET_SIZE) {
+        if (rx_index > 0 && rx_index < packet_size(rx_buffer[0])) {
             rx_index = 0;
+            aborted_transfer_count++;
         }
     }
+    
+    if (stress_mode) {
+        stress_irq_sample(entry_fifo_level, time_us_32() - entry_us);
+    }
+}
+
+// Display bytes of the current speech features
+static feature_row_t feature_row_now(void) {
+    speech_state_t speech;
+    speech_features_get(&speech);
+    
+    feature_row_t row;
+    uint32_t energy = speech.features.energy_db_q8 >> 6;
+    uint32_t centroid = (speech.features.centroid_hz > FEATURE_BIN0_HZ)
+        ? (speech.features.centroid_hz - FEATURE_BIN0_HZ) * 256 / (NUM_FREQ_BINS * FEATURE_BIN_HZ) : 0;
+    row.energy = (energy > 255) ? 255 : energy;
+    row.centroid = (centroid > 255) ? 255 : centroid;
+    row.flatness = (speech.features.flatness_q8 > 255) ? 255 : speech.features.flatness_q8;
+    row.voice = speech.voice;
+    return row;
+}
+
+// Count packets of a channel and the gaps in its sequence numbers
+static void channel_sequence(int channel, uint8_t seq) {
+    if (channel_seq_valid[channel]) {
+        channel_lost[channel] += (uint8_t)(seq - channel_next_seq[channel]);
+    }
+    channel_next_seq[channel] = seq + 1;
+    channel_seq_valid[channel] = true;
 }
 
 // Parse and display received packet
 void process_packet(void) {
+    int channel = 0;
+    const uint8_t *bins = &rx_buffer[1];
+    
     // Verify header
-    if (rx_buffer[0] != PACKET_HEADER) {
-        printf("Invalid header: 0x%02X (expected 0x%02X)\n", rx_buffer[0], PACKET_HEADER);
+    if (rx_buffer[0] == CHANNEL_PACKET_HEADER) {
+        channel = rx_buffer[1];
+        if (channel >= SPECTRO_CHANNELS) {
+            invalid_channel_count++;
+            LOG2(LOG_INVALID_CHANNEL, channel, SPECTRO_CHANNELS);
+            return;
+        }
+        channel_sequence(channel, rx_buffer[2]);
+        bins = &rx_buffer[3];
+    } else if (rx_buffer[0] != PACKET_HEADER) {
+        invalid_header_count++;
+        LOG2(LOG_INVALID_HEADER, rx_buffer[0], PACKET_HEADER);
+        return;
+    } else if (stress_mode) {
+        // Test pattern from stress_master: sequence/checksum and consumer lag
+        // only. It never reaches the statistics, speech features, history
+        // ring, pyramid or flash history, which would otherwise fill with
+        // 0xAA pattern rows.
+        stress_packet(rx_buffer, time_us_32() - packet_ready_us);
+        packet_count++;
+        return;
+    }
+    
+    // Other channels only keep their history ring
+    if (channel != 0) {
+        int head = spectrogram_head[channel];
+        store_pack_row(bins, spectrogram_buffer[channel][head]);
+        spectrogram_head[channel] = (head + 1) % SPECTROGRAM_DEPTH;
+        channel_packets[channel]++;
+        packet_count++;
+        display_update_needed = true;
         return;
     }
     
     // Extract frequency bins (8-bit values)
     for (int i = 0; i < NUM_FREQ_BINS; i++) {
-        freq_bins[i] = rx_buffer[1 + i];
+        freq_bins[i] = bins[i];
     }
     
-    // Circular buffer insert: NO data copying! Just update index and overwrite oldest
-    // Insert new data at current head position
-    for (int col = 0; col < NUM_FREQ_BINS; col++) {
-        spectrogram_buffer[spectrogram_head][col] = freq_bins[col];
+    // Long-running per-bin statistics (bounded fixed-point cost per packet)
+    bin_stats_update(freq_bins, NUM_FREQ_BINS);
+    
+    // Speech indicators and voice activity (fixed-point, one pass over the bins)
+    if (speech_features_update(freq_bins, NUM_FREQ_BINS)) {
+        speech_state_t speech;
+        speech_features_get(&speech);
+        if (speech.voice) {
+            LOG2(LOG_VOICE_START, speech.features.energy_db_q8 / 256, speech.noise_floor_db_q8 / 256);
+        } else {
+            LOG1(LOG_VOICE_END, speech.voice_segments);
+        }
     }
+    int head = spectrogram_head[0];
+    feature_rows[head] = feature_row_now();
+    
+    // Long-term history: compressed into a RAM sector buffer, written to flash by Core 1
+    flash_history_append(to_ms_since_boot(get_absolute_time()), freq_bins);
+    
+    // Circular buffer insert: NO data copying! Just update index and overwrite oldest
+    // Insert new data at current head position (quantized and packed for 4-bit storage)
+    const uint8_t *row = spectrogram_buffer[0][head];
+    store_pack_row(freq_bins, spectrogram_buffer[0][head]);
     
     // Move head forward (circular wrap)
-    spectrogram_head = (spectrogram_head + 1) % SPECTROGRAM_DEPTH;
+    spectrogram_head[0] = (head + 1) % SPECTROGRAM_DEPTH;
+    
+    // Coarser time scales: pooled rows cascade up the pyramid levels
+    history_pyramid_push(row);
     
     // Count packets for performance monitoring
+    channel_packets[0]++;
     packet_count++;
     
     // Mark display for update
@@ -170,145 +471,527 @@ void process_packet(void) {
     // if (packet_count % 62 == 0) printf(" %u pkts\n", packet_count);  // Every 1 sec
 }
 
-// Map magnitude value to color (spectrogram gradient)
-// Black → Blue → Cyan → Green → Yellow → Red
-// RGB565: RRRRRGGGGGGBBBBB (5-bit R, 6-bit G, 5-bit B)
-uint16_t magnitude_to_color(uint8_t value, uint8_t max_value) {
-    if (value == 0 || max_value == 0) return COLOR_BLACK;  // 0x0000
-    
-    // Normalize to 0-255 range
-    int intensity = (value * 255) / max_value;
-    if (intensity > 255) intensity = 255;
-    if (intensity < 0) intensity = 0;
-    
-    int r, g, b;
-    
-    // Color gradient mapping (0-255 intensity range)
-    if (intensity < 51) {
-        // Black → Blue (0-20%)
-        r = 0;
-        g = 0;
-        b = (intensity * 255) / 51;  // 0 → 255
-    } else if (intensity < 102) {
-        // Blue → Cyan (20-40%)
-        r = 0;
-        g = ((intensity - 51) * 255) / 51;  // 0 → 255
-        b = 255;
-    } else if (intensity < 153) {
-        // Cyan → Green (40-60%)
-        r = 0;
-        g = 255;
-        b = 255 - ((intensity - 102) * 255) / 51;  // 255 → 0
-        if (b < 0) b = 0;
-    } else if (intensity < 204) {
-        // Green → Yellow (60-80%)
-        r = ((intensity - 153) * 255) / 51;  // 0 → 255
-        g = 255;
-        b = 0;
-    } else {
-        // Yellow → Red (80-100%)
-        r = 255;
-        g = 255 - ((intensity - 204) * 255) / 51;  // 255 → 0
-        if (g < 0) g = 0;
-        b = 0;
+// Circular buffer index of a sample by age (0 = newest, at head-1)
+static inline int history_index(int current_head, int age) {
+    return (current_head - 1 - age + SPECTROGRAM_DEPTH) % SPECTROGRAM_DEPTH;
+}
+
+// Head of the selected time scale (captured once per frame)
+static inline int view_source_head(void) {
+    return (view_time_level == 0) ? spectrogram_head[0] : history_pyramid_head(view_time_level);
+}
+
+// Compose and send one tile row of the feature strip if its rows changed;
+// returns SPI bytes sent. Only the live level has per-frame features, so
+// the strip is blank on coarser time scales.
+static uint32_t send_feature_strip(int ty, int live_head, bool full_redraw) {
+    int tile_h = TILE_VISIBLE_H(ty);
+    if (tile_h == 0) return 0;
+    
+    uint32_t hash = fnv1a(2166136261u, view_time_level | (palette_id << 8));
+    hash = fnv1a(hash, (view_first_age << 16) | view_num_rows);
+    if (view_time_level == 0) {
+        for (int r = tile_row_first[ty]; r < tile_row_end[ty]; r++) {
+            int index = live_head - 1 - view_rows[r].age;
+            if (index < 0) index += SPECTROGRAM_DEPTH;
+            const feature_row_t *f = &feature_rows[index];
+            hash = fnv1a(hash, f->energy | (f->centroid << 8) | (f->flatness << 16) | (f->voice << 24));
+        }
+    }
+    if (!full_redraw && hash == feature_strip_hash[ty]) return 0;
+    feature_strip_hash[ty] = hash;
+    
+    int prev_r = -1;
+    for (int j = 0; j < tile_h; j++) {
+        uint16_t *out = &feature_strip_pixels[j * FEATURE_STRIP_W];
+        int r = view_row_at(ty * TILE_H + j, view_num_rows);
+        if (r == prev_r) {
+            memcpy(out, out - FEATURE_STRIP_W, FEATURE_STRIP_W * sizeof(uint16_t));
+            continue;
+        }
+        prev_r = r;
+        
+        uint16_t lane_color[FEATURE_LANES] = {COLOR_BLACK, COLOR_BLACK, COLOR_BLACK, COLOR_BLACK};
+        if (view_time_level == 0) {
+            int index = live_head - 1 - view_rows[r].age;
+            if (index < 0) index += SPECTROGRAM_DEPTH;
+            const feature_row_t *f = &feature_rows[index];
+            lane_color[0] = palette_color(f->energy, 255, palette_id);
+            lane_color[1] = palette_color(f->centroid, 255, palette_id);
+            lane_color[2] = palette_color(f->flatness, 255, PALETTE_GRAY);
+            lane_color[3] = f->voice ? COLOR_GREEN : COLOR_BLACK;
+        }
+        
+        // Lanes separated by one black pixel column; leftover columns stay black
+        int x = 0;
+        for (int lane = 0; lane < FEATURE_LANES; lane++) {
+            for (int i = 0; i < FEATURE_LANE_W; i++) {
+                out[x++] = lane_color[lane];
+            }
+            if (lane < FEATURE_LANES - 1) out[x++] = COLOR_BLACK;
+        }
+        while (x < FEATURE_STRIP_W) {
+            out[x++] = COLOR_BLACK;
+        }
     }
     
-    // Bounds check all components
-    if (r < 0) r = 0; if (r > 255) r = 255;
-    if (g < 0) g = 0; if (g > 255) g = 255;
-    if (b < 0) b = 0; if (b > 255) b = 255;
+    st7796_draw_bitmap_unclipped(FEATURE_STRIP_X, SPECTRO_Y + ty * TILE_H, FEATURE_STRIP_W, tile_h,
+                                 feature_strip_pixels);
+    uint32_t bytes = ST7796_WINDOW_SETUP_BYTES + FEATURE_STRIP_W * tile_h * 2;
+    frame_bus_bytes += bytes;
+    frame_blits++;
+    return bytes;
+}
+
+// Current speech features as bars above the strip, and the voice flag
+static void draw_feature_bars(void) {
+    speech_state_t speech;
+    speech_features_get(&speech);
+    feature_row_t now = feature_row_now();
+    
+    int x = FEATURE_STRIP_X;
+    int h = SPECTRO_Y - 4;
+    st7796_draw_vbar(x, 2, FEATURE_LANE_W, h, now.energy, 255, COLOR_YELLOW);
+    x += FEATURE_LANE_W + 1;
+    st7796_draw_vbar(x, 2, FEATURE_LANE_W, h, now.centroid, 255, COLOR_CYAN);
+    x += FEATURE_LANE_W + 1;
+    st7796_draw_vbar(x, 2, FEATURE_LANE_W, h, now.flatness, 255, COLOR_GRAY);
+    x += FEATURE_LANE_W + 1;
+    st7796_draw_vbar(x, 2, FEATURE_LANE_W, h, speech.voice, 1, COLOR_GREEN);
+}
+
+// Compose rows as panel lines (oldest first, from oldest_age down to the
+// newest) and write them from frame-memory line on, in windows of up to
+// SCROLL_BATCH_ROWS rows. Bin 0 is the first pixel of a line: the bottom.
+static void scroll_send_rows(const uint8_t **rows, int oldest_age, int count, int line) {
+#if SCROLL_SUPPORTED
+    const int line_px = SCROLL_COLUMN_W * LCD_WIDTH;
+    
+    while (count > 0) {
+        int n = (count < SCROLL_BATCH_ROWS) ? count : SCROLL_BATCH_ROWS;
+        int lines_left = (SCROLL_AREA_W - line) / SCROLL_COLUMN_W;  // Before the wrap
+        if (n > lines_left) n = lines_left;
+        
+        for (int k = 0; k < n; k++) {
+            const uint8_t *samples = rows[oldest_age - k];
+            uint16_t *out = scroll_pixels + k * line_px;
+            for (int bin = 0; bin < NUM_FREQ_BINS; bin++) {
+                uint16_t color = palette_lut[store_get(samples, bin)];
+                for (int i = 0; i < SCROLL_BIN_H; i++) {
+                    *out++ = color;
+                }
+            }
+            for (int c = 1; c < SCROLL_COLUMN_W; c++) {
+                memcpy(scroll_pixels + k * line_px + c * LCD_WIDTH, scroll_pixels + k * line_px,
+                       LCD_WIDTH * sizeof(uint16_t));
+            }
+        }
+        st7796_write_lines(line, n * SCROLL_COLUMN_W, scroll_pixels);
+        frame_bus_bytes += ST7796_LINES_SETUP_BYTES + n * line_px * 2;
+        frame_blits++;
+        
+        line = (line + n * SCROLL_COLUMN_W) % SCROLL_AREA_W;
+        oldest_age -= n;
+        count -= n;
+    }
+#else
+    (void)rows;
+    (void)oldest_age;
+    (void)count;
+    (void)line;
+#endif
+}
+
+// Scroll layout: write the rows added since the last frame at the oldest
+// (leftmost) columns and advance the scroll start past them, so they appear
+// at the right edge. Columns already on the panel keep the colors they were
+// drawn with. After a settings change, or when more rows arrived than the
+// history holds, the whole waterfall is redrawn. Returns rows sent.
+static uint32_t scroll_render(const uint8_t **rows, int head) {
+    uint32_t count = history_pyramid_count(view_time_level);
+    int new_rows = (head - scroll_head + SPECTROGRAM_DEPTH) % SPECTROGRAM_DEPTH;
+    
+    if (!scroll_valid || count - scroll_count >= SPECTROGRAM_DEPTH || new_rows > SCROLL_COLUMNS) {
+        // Newest rows of the displayed depth that fit, ending at the right edge
+        st7796_fill_screen(COLOR_BLACK);
+        st7796_set_scroll_area(0, SCROLL_AREA_W, LCD_HEIGHT - SCROLL_AREA_W);
+        st7796_set_scroll_start(0);
+        scroll_start = 0;
+        new_rows = (spectrogram_depth < SCROLL_COLUMNS) ? spectrogram_depth : SCROLL_COLUMNS;
+        scroll_send_rows(rows, new_rows - 1, new_rows, SCROLL_AREA_W - new_rows * SCROLL_COLUMN_W);
+        scroll_valid = true;
+    } else if (new_rows > 0) {
+        scroll_send_rows(rows, new_rows - 1, new_rows, scroll_start);
+        scroll_start = (scroll_start + new_rows * SCROLL_COLUMN_W) % SCROLL_AREA_W;
+        st7796_set_scroll_start(scroll_start);
+        frame_bus_bytes += ST7796_SCROLL_START_BYTES;
+    }
     
-    // Convert RGB888 (8-bit each) to RGB565 format
-    // RGB565: bit 15-11=R(5bits), bit 10-5=G(6bits), bit 4-0=B(5bits)
-    uint16_t r5 = (r >> 3) & 0x1F;  // 8-bit to 5-bit
-    uint16_t g6 = (g >> 2) & 0x3F;  // 8-bit to 6-bit
-    uint16_t b5 = (b >> 3) & 0x1F;  // 8-bit to 5-bit
+    scroll_head = head;
+    scroll_count = count;
+    return new_rows;
+}
+
+// Back to the row layout: panel scrolling off, cleared for a full redraw
+static void scroll_leave(void) {
+    st7796_scroll_off();
+    st7796_fill_screen(COLOR_BLACK);
+    tile_hash_valid = false;
+    spectro_area_black = true;
+}
+
+// Top pixel row of pane p (the pane ends SPLIT_GAP rows above the next one)
+static inline int split_pane_y(int p) {
+    return SPECTRO_Y + p * (SPECTRO_VISIBLE_H + SPLIT_GAP) / split_panes;
+}
+
+// Capture every channel's head and return the largest code over the rows
+// the panes show (Core 0 keeps writing, so the frame works on the snapshot)
+static uint8_t split_capture(void) {
+    int pane_h = split_pane_y(1) - SPECTRO_Y - SPLIT_GAP;
+    split_rows = pane_h / SPECTRO_PIXEL_H;
+    if (split_rows > spectrogram_depth) split_rows = spectrogram_depth;
+    
+    uint8_t max_code = 0;
+    for (int c = 0; c < split_panes; c++) {
+        split_head[c] = spectrogram_head[c];
+        history_rows_build(spectrogram_buffer[c], split_head[c], split_pane_rows);
+        for (int age = 0; age < split_rows; age++) {
+            uint8_t row_max = store_row_max(split_pane_rows[age]);
+            if (row_max > max_code) max_code = row_max;
+        }
+    }
+    return max_code;
+}
+
+// Compose one sample row at full width (bin cells with a divider at the
+// left, like the block renderer) and repeat it for the cell height
+static void split_compose_row(const uint8_t *samples) {
+    uint16_t *out = tile_pixels;
+    for (int bin = 0; bin < NUM_FREQ_BINS; bin++) {
+        uint16_t color = palette_lut[store_get(samples, bin)];
+        *out++ = COLOR_DARKGRAY;
+        for (int x = 1; x < SPECTRO_PIXEL_W; x++) {
+            *out++ = color;
+        }
+    }
+    for (int y = 1; y < SPECTRO_PIXEL_H; y++) {
+        memcpy(tile_pixels + y * SPECTRO_W, tile_pixels, SPECTRO_W * sizeof(uint16_t));
+    }
+}
+
+// Split layout: walk every pane's rows newest first and send the ones that
+// changed. Pane cost (time and bus bytes) is kept per channel. Returns rows sent.
+static uint32_t split_render(uint8_t max_value) {
+    bool full_redraw = !split_valid;
+    if (full_redraw) {
+        st7796_fill_rect(0, SPECTRO_Y, SCREEN_W, SPECTRO_VISIBLE_H, COLOR_BLACK);
+        frame_bus_bytes += ST7796_WINDOW_SETUP_BYTES + SCREEN_W * SPECTRO_VISIBLE_H * 2;
+        frame_fills++;
+    }
+    
+    uint32_t scale = max_value | (palette_id << 8);
+    uint32_t rows_sent = 0;
+    for (int c = 0; c < split_panes; c++) {
+        uint32_t pane_start_us = time_us_32();
+        uint32_t bytes_before = frame_bus_bytes;
+        int y = split_pane_y(c);
+        history_rows_build(spectrogram_buffer[c], split_head[c], split_pane_rows);
+        
+        for (int age = 0; age < split_rows; age++, y += SPECTRO_PIXEL_H) {
+            const uint8_t *samples = split_pane_rows[age];
+            uint32_t hash = fnv1a(2166136261u, scale);
+            for (int i = 0; i < STORE_ROW_BYTES; i++) {
+                hash = fnv1a(hash, samples[i]);
+            }
+            
+            uint32_t row_bytes = ST7796_WINDOW_SETUP_BYTES + SPECTRO_W * SPECTRO_PIXEL_H * 2;
+            if (!full_redraw && hash == split_row_hash[c][age]) {
+                spi_bytes_saved += row_bytes;
+                continue;
+            }
+            split_row_hash[c][age] = hash;
+            
+            split_compose_row(samples);
+            band_send(0, y, SPECTRO_W, SPECTRO_PIXEL_H);
+            frame_bus_bytes += row_bytes;
+            rows_sent++;
+        }
+        
+        channel_render_us[c] = time_us_32() - pane_start_us;
+        channel_bus_bytes[c] = frame_bus_bytes - bytes_before;
+    }
     
-    return (r5 << 11) | (g6 << 5) | b5;
+    split_valid = true;
+    return rows_sent;
+}
+
+// Bus cost of the last frame, and the pipeline load apart from it: the BUS
+// line stays under 32 characters so it ends left of the feature bars
+static void draw_bus_status(char *buffer, size_t size) {
+    snprintf(buffer, size, "BUS %6u B %5u US F%u B%u", bus_bytes_last_frame, render_us_last_frame,
+             span_fills_last_frame, span_blits_last_frame);
+    st7796_draw_string(STATUS_X, STATUS_Y + 17, buffer, COLOR_CYAN, COLOR_BLACK, 1);
+    snprintf(buffer, size, "U%3u/%-3u", compose_busy_pct, spi_busy_pct);
+    st7796_draw_string(LOAD_X, LOAD_Y, buffer, COLOR_CYAN, COLOR_BLACK, 1);
+}
+
+// Per-pane labels in the band right of the panes: channel, rate, lost packets
+static void split_draw_labels(void) {
+    char buffer[12];
+    for (int c = 0; c < split_panes; c++) {
+        int y = split_pane_y(c);
+        snprintf(buffer, sizeof(buffer), "CH%u", c);
+        st7796_draw_string(FEATURE_STRIP_X, y, buffer, COLOR_YELLOW, COLOR_BLACK, 1);
+        snprintf(buffer, sizeof(buffer), "%3u/S", channel_rate[c]);
+        st7796_draw_string(FEATURE_STRIP_X, y + 10, buffer, COLOR_CYAN, COLOR_BLACK, 1);
+        snprintf(buffer, sizeof(buffer), "L%4u", channel_lost[c] % 10000);
+        st7796_draw_string(FEATURE_STRIP_X, y + 20, buffer,
+                           channel_lost[c] ? COLOR_RED : COLOR_CYAN, COLOR_BLACK, 1);
+    }
+}
+
+// Back to the single layout: panes and labels cleared for a full redraw
+static void split_leave(void) {
+    st7796_fill_rect(0, SPECTRO_Y, SCREEN_W, SPECTRO_VISIBLE_H, COLOR_BLACK);
+    tile_hash_valid = false;
+    spectro_area_black = true;
 }
 
 // Update TFT display with spectrogram
 void update_display(void) {
-    char buffer[32];
+    char buffer[40];
+    
+    // Latch parameter changes from the control channel
+    bool was_split = split_panes > 1 && !scroll_mode;
+    if (display_params_pending) {
+        display_params_pending = false;
+        render_mode = display_params_requested.render_mode;
+        freq_warp = display_params_requested.freq_warp;
+        interp_time = display_params_requested.interp_time;
+        spectrogram_depth = display_params_requested.spectrogram_depth;
+        palette_id = display_params_requested.palette;
+        gain_floor = display_params_requested.gain_floor;
+        view_time_level = display_params_requested.time_level;
+        view_source = (view_time_level == 0) ? (pyramid_rows_t)spectrogram_buffer[0]
+                                             : history_pyramid_rows(view_time_level);
+        view_changed = true;
+        if (scroll_mode && !display_params_requested.scroll_mode) {
+            scroll_leave();
+        }
+        scroll_mode = display_params_requested.scroll_mode;
+        scroll_valid = false;
+        split_panes = display_params_requested.channels;
+        split_valid = false;
+    }
+    bool split = split_panes > 1 && !scroll_mode;
+    if (was_split && !split && !scroll_mode) {
+        split_leave();
+    }
     
-    // Display current I2C address at top
-    snprintf(buffer, sizeof(buffer), "I2C: 0x%02X", current_i2c_address);
-    st7796_draw_string(5, 5, buffer, COLOR_YELLOW, COLOR_BLACK, 2);
+    // Display current I2C address at top (the header would scroll in scroll mode)
+    if (!scroll_mode) {
+        snprintf(buffer, sizeof(buffer), "I2C: 0x%02X", current_i2c_address);
+        st7796_draw_string(5, 5, buffer, COLOR_YELLOW, COLOR_BLACK, 2);
+    }
     
     // Performance monitoring: show packet rate every 500ms
     uint32_t now = to_ms_since_boot(get_absolute_time());
+    bool rate_changed = false;
     if ((now - last_perf_check_ms) >= 500) {
         uint32_t pkts_received = packet_count - last_packet_count;
         last_packet_count = packet_count;
         last_perf_check_ms = now;
         
         // Show packets per second (500ms = *2)
-        snprintf(buffer, sizeof(buffer), "%u pkt/s", pkts_received * 2);
-        st7796_draw_string(250, 5, buffer, COLOR_CYAN, COLOR_BLACK, 1);
+        packet_rate = pkts_received * 2;
+        for (int c = 0; c < SPECTRO_CHANNELS; c++) {
+            uint32_t count = channel_packets[c];
+            channel_rate[c] = (count - channel_last_packets[c]) * 2;
+            channel_last_packets[c] = count;
+        }
+        rate_changed = true;
+    }
+    if ((rate_changed || recovery_replay_pending) && !scroll_mode) {
+        snprintf(buffer, sizeof(buffer), "%u PKT/S", packet_rate);
+        st7796_draw_string(STATUS_X, STATUS_Y, buffer, COLOR_CYAN, COLOR_BLACK, 1);
     }
     
-    // Capture current head position (volatile)
-    int current_head = spectrogram_head;
+    // Capture the rows of the displayed level (head is advanced by Core 0).
+    // Static: at 290 rows (profile 2) the table is 1160 B, too much for
+    // Core 1's 2 KB stack. Only Core 1 renders, so it is never shared.
+    int head = view_source_head();
+    static const uint8_t *rows[SPECTROGRAM_DEPTH];
+    history_rows_build(view_source, head, rows);
+    
+    // Time scale: frames per row and the span of the displayed depth
+    uint32_t frames_per_row = 1u << view_time_level;
+    uint32_t span_ds = (packet_rate > 0) ? spectrogram_depth * frames_per_row * 10 / packet_rate : 0;
+    if (!scroll_mode) {
+        snprintf(buffer, sizeof(buffer), "%2uX %4u.%uS", frames_per_row, span_ds / 10, span_ds % 10);
+        st7796_draw_string(130, 5, buffer, COLOR_CYAN, COLOR_BLACK, 1);
+    }
     
-    // Find max value in buffer for color scaling
-    uint8_t max_value = 1;
-    for (int row = 0; row < SPECTROGRAM_DEPTH; row++) {
-        for (int col = 0; col < NUM_FREQ_BINS; col++) {
-            if (spectrogram_buffer[row][col] > max_value) {
-                max_value = spectrogram_buffer[row][col];
+    // Find max value in the displayed history for color scaling (over all
+    // panes in the split layout, so they share one scale)
+    uint8_t max_code = 0;
+    if (split) {
+        max_code = split_capture();
+    } else {
+        for (int age = 0; age < spectrogram_depth; age++) {
+            uint8_t row_max = store_row_max(rows[age]);
+            if (row_max > max_code) {
+                max_code = row_max;
             }
         }
     }
-    if (max_value < 16) max_value = 16;  // Minimum scaling
+    uint8_t max_value = store_dequant(max_code);
+    if (max_value < gain_floor) max_value = gain_floor;  // Minimum scaling
+    
+    render_palette_update(max_value);
+    
+    uint32_t render_start_us = time_us_32();
+    uint32_t wait_start_us = st7796_dma_wait_us();
+    frame_bus_bytes = 0;
+    frame_fills = 0;
+    frame_blits = 0;
+    frame_compose_us = 0;
+    frame_composed_pixels = 0;
+    
+    uint32_t tiles_sent = 0;
+    uint32_t rows_scrolled = 0;
+    if (scroll_mode) {
+        rows_scrolled = scroll_render(rows, head);
+    } else if (split) {
+        split_rows_sent = split_render(max_value);
+    } else {
+        // Feature strip beside the waterfall, same rows and same partial refresh
+        bool full_redraw = !tile_hash_valid;
+        tiles_sent = render_tiles(rows, max_value);
+        int live_head = spectrogram_head[0];
+        for (int ty = 0; ty < TILES_Y_VISIBLE; ty++) {
+            send_feature_strip(ty, live_head, full_redraw);
+        }
+    }
+    draw_feature_bars();
+    st7796_dma_wait();  // The frame ends when its last band is on the panel
+    
+    display_frames++;
+    tiles_sent_last_frame = tiles_sent;
+    bus_bytes_last_frame = frame_bus_bytes;
+    span_fills_last_frame = frame_fills;
+    span_blits_last_frame = frame_blits;
+    render_us_last_frame = time_us_32() - render_start_us;
+    
+    // Pipeline stages: the CPU composes whenever it is not waiting for DMA,
+    // the bus is busy for the bytes sent at the SPI clock
+    dma_wait_us_last_frame = st7796_dma_wait_us() - wait_start_us;
+    if (render_us_last_frame > 0) {
+        uint32_t spi_us = (uint32_t)((uint64_t)bus_bytes_last_frame * 8 * 1000000 / ST7796_SPI_HZ);
+        uint32_t busy_us = render_us_last_frame - dma_wait_us_last_frame;
+        compose_busy_pct = busy_us * 100 / render_us_last_frame;
+        spi_busy_pct = spi_us * 100 / render_us_last_frame;
+        if (spi_busy_pct > 100) spi_busy_pct = 100;
+    }
+    if (frame_composed_pixels > 0) {
+        compose_ns_per_pixel = (frame_compose_us * 1000) / frame_composed_pixels;
+    }
     
-    // Draw spectrogram: 40 bins × 12px wide = 480px, 100 samples × 3px tall = 300px
-    const int pixel_width = 12;   // Each frequency bin is 12 pixels wide
-    const int pixel_height = 3;   // Each time sample is 3 pixels tall
-    const int start_y = 30;        // Start below the I2C address text
+    // First frame after a watchdog recovery: the history is back on the panel
+    if (recovery_replay_pending) {
+        recovery_replay_pending = false;
+        recovery_last_us = time_us_32() - recovery_start_us;
+        if (recovery_last_us > recovery_max_us) recovery_max_us = recovery_last_us;
+        LOG2(LOG_DISPLAY_RECOVERED, recovery_stage, recovery_last_us);
+    }
+    if (!split) {
+        // Single layout: channel 0 is the whole frame, other channels are not drawn
+        for (int c = 0; c < SPECTRO_CHANNELS; c++) {
+            channel_render_us[c] = (c == 0) ? render_us_last_frame : 0;
+            channel_bus_bytes[c] = (c == 0) ? bus_bytes_last_frame : 0;
+        }
+    }
     
-    // Draw from newest (head-1) to oldest (head-100), wrapping circularly
-    for (int display_row = 0; display_row < SPECTROGRAM_DEPTH; display_row++) {
-        // Calculate circular buffer index: newest at top, oldest at bottom
-        // head-1 is newest, head-2 is next, etc., wrapping at 0
-        int buffer_idx = (current_head - 1 - display_row + SPECTROGRAM_DEPTH) % SPECTROGRAM_DEPTH;
-        
-        for (int col = 0; col < NUM_FREQ_BINS; col++) {
-            uint8_t value = spectrogram_buffer[buffer_idx][col];
-            uint16_t color = magnitude_to_color(value, max_value);
-            
-            int x = col * pixel_width;
-            int y = start_y + display_row * pixel_height;
-            
-            // Draw a solid rectangle for this pixel
-            st7796_fill_rect(x, y, pixel_width, pixel_height, color);
+    if (scroll_mode) {
+        // Rate and bus cost per history row in the fixed band
+        if (rows_scrolled > 0) {
+            scroll_bytes_per_row = bus_bytes_last_frame / rows_scrolled;
         }
+        snprintf(buffer, sizeof(buffer), "%3u/S", packet_rate);
+        st7796_draw_string(FEATURE_STRIP_X, SPECTRO_Y + 10, buffer, COLOR_CYAN, COLOR_BLACK, 1);
+        st7796_draw_string(FEATURE_STRIP_X, SPECTRO_Y + 30, "B/ROW", COLOR_CYAN, COLOR_BLACK, 1);
+        snprintf(buffer, sizeof(buffer), "%5u", scroll_bytes_per_row);
+        st7796_draw_string(FEATURE_STRIP_X, SPECTRO_Y + 40, buffer, COLOR_CYAN, COLOR_BLACK, 1);
+        st7796_draw_string(FEATURE_STRIP_X, SPECTRO_Y + 60, "US", COLOR_CYAN, COLOR_BLACK, 1);
+        snprintf(buffer, sizeof(buffer), "%5u", render_us_last_frame);
+        st7796_draw_string(FEATURE_STRIP_X, SPECTRO_Y + 70, buffer, COLOR_CYAN, COLOR_BLACK, 1);
+        display_update_needed = false;
+        return;
     }
-
-    // Draw column dividers to distinguish bins
-    const uint16_t divider_color = COLOR_DARKGRAY;
-    const int divider_height = SPECTROGRAM_DEPTH * pixel_height;
-    for (int col = 0; col < NUM_FREQ_BINS; col++) {
-        int x = col * pixel_width;
-        st7796_fill_rect(x, start_y, 1, divider_height, divider_color);
+    
+    if (split) {
+        // Rows sent over rows shown, and RAM per channel
+        split_draw_labels();
+        snprintf(buffer, sizeof(buffer), "PANES %3u/%-3u MEM %5uB/CH", split_rows_sent,
+                 split_rows * split_panes, (unsigned)CHANNEL_MEMORY_BYTES);
+        st7796_draw_string(STATUS_X, STATUS_Y + 10, buffer, COLOR_CYAN, COLOR_BLACK, 1);
+        draw_bus_status(buffer, sizeof(buffer));
+        display_update_needed = false;
+        return;
+    }
+    
+    // Partial refresh statistics
+    snprintf(buffer, sizeof(buffer), "TILES %3u/%u SAVED %6luK", tiles_sent, NUM_TILES,
+             (unsigned long)(spi_bytes_saved / 1024));
+    st7796_draw_string(STATUS_X, STATUS_Y + 10, buffer, COLOR_CYAN, COLOR_BLACK, 1);
+    draw_bus_status(buffer, sizeof(buffer));
+    if (render_mode != RENDER_BLOCKS) {
+        snprintf(buffer, sizeof(buffer), "%4u NS/PX", compose_ns_per_pixel);
+        st7796_draw_string(STATUS_X + 90, STATUS_Y, buffer, COLOR_CYAN, COLOR_BLACK, 1);
     }
     
     display_update_needed = false;
 }
 
 static void recover_display(void) {
-    // Pause Core 1 and reset it
+    recovery_start_us = time_us_32();
+    
+    // Pause Core 1 and reset it, never in the middle of a flash write (XIP
+    // would stay off for the history readout on this core)
     core1_paused = true;
     sleep_ms(50);
+    for (int ms = 0; flash_history_writing() && ms < CORE1_FLASH_WAIT_MS; ms++) {
+        sleep_ms(1);
+    }
     multicore_reset_core1();
+    flash_history_recover();  // Release the lock, retry a claimed sector
 
-    // Reinitialize display hardware
-    st7796_init();
-    st7796_set_rotation(1); // Landscape mode (480x320)
-    st7796_fill_screen(COLOR_BLACK);
+    // Stage 1: resync bus and panel state, keep the frame memory. Without
+    // readback there is no way to tell it worked, so go straight to stage 2.
+    if (display_readback && st7796_resync()) {
+        recovery_stage = RECOVERY_SOFT;
+        recovery_soft_count++;
+        spectro_area_black = false;
+    } else {
+        // Stage 2: full reset (~430 ms of sleeps) and clear
+        recovery_stage = RECOVERY_HARD;
+        recovery_hard_count++;
+        st7796_init();
+        st7796_set_rotation(SPECTRO_ROTATION);
+        if (display_readback && !st7796_verify()) {
+            recovery_failed_count++;
+        }
+        st7796_fill_screen(COLOR_BLACK);
+        spectro_area_black = true;
+    }
+    tile_hash_valid = false;  // Replay the whole history in the next frame
+    scroll_valid = false;     // Resync and reset both leave the panel's scroll mode
+    split_valid = false;
+    recovery_replay_pending = true;
+    redraw_requested = true;
 
-    // Relaunch Core 1
+    // Relaunch Core 1: its first frame is due at once and replays everything
     multicore_launch_core1(core1_display_loop);
-    sleep_ms(100);
     core1_paused = false;
     core1_last_beat_ms = to_ms_since_boot(get_absolute_time());
 }
@@ -317,22 +1000,43 @@ static void recover_display(void) {
 // This runs independently and continuously updates the display
 // without blocking I2C reception on Core 0
 void core1_display_loop(void) {
-    if (DEBUG_VERBOSE) printf("[Core 1] Display renderer started\n");
+    if (debug_verbose) LOG0(LOG_CORE1_STARTED);
     
     uint32_t last_update_time = 0;
     
+    // Touch reports are read and decoded on this core, next to the view tables
+    touch_enable_irq();
+    
     // Continuous display updates
     while (1) {
         uint32_t now = to_ms_since_boot(get_absolute_time());
         
         // Check if Core 0 is requesting a pause (for address change)
         if (!core1_paused) {
-            // Update display at a fixed interval to reduce SPI load
-            if ((now - last_update_time) >= DISPLAY_UPDATE_MS) {
+            // Heartbeat on every pass, not only after a frame: the update
+            // interval can be longer than the watchdog timeout
+            core1_last_beat_ms = now;
+            
+            touch_gesture_t gesture;
+            // No zoom or pan in the waterfall or panes
+            bool view_gestures = !scroll_mode && split_panes <= 1;
+            if (touch_poll(now, &gesture) && view_gestures && view_apply_gesture(&gesture)) {
+                redraw_requested = true;
+            }
+            
+            // Update display at a fixed interval to reduce SPI load, or sooner
+            // when the view was zoomed or panned or a parameter was changed
+            bool redraw_due = redraw_requested && (now - last_update_time) >= VIEW_REDRAW_MIN_MS;
+            if (redraw_due || (now - last_update_time) >= display_update_ms) {
+                redraw_requested = false;
                 update_display();
                 last_update_time = now;
-                core1_last_beat_ms = now;
             }
+            
+            // Write a full history sector, if any (~50 ms, Core 0 keeps receiving).
+            // Beat first: the watchdog does not fire while a write is running.
+            core1_last_beat_ms = to_ms_since_boot(get_absolute_time());
+            flash_history_task();
         }
         
         tight_loop_contents();
@@ -359,7 +1063,7 @@ void reconfigure_i2c_address(void) {
     packet_ready = false;
     
     // Clear the receive buffer to avoid stale data
-    memset(rx_buffer, 0, PACKET_SIZE);
+    memset(rx_buffer, 0, RX_BUFFER_SIZE);
     
     // Set new slave address
     hw->sar = current_i2c_address;
@@ -375,7 +1079,7 @@ void reconfigure_i2c_address(void) {
     // Re-enable interrupts
     irq_set_enabled(I2C0_IRQ, true);
     
-    printf("I2C address changed to: 0x%02X\n", current_i2c_address);
+    LOG1(LOG_ADDRESS_CHANGED, current_i2c_address);
     
     // Update display with new address BEFORE resuming Core 1
     // Resume Core 1 display rendering AFTER address change completes
@@ -384,6 +1088,379 @@ void reconfigure_i2c_address(void) {
     address_changed = false;
 }
 
+static void put_u32_le(uint8_t *dst, uint32_t value) {
+    dst[0] = value & 0xFF;
+    dst[1] = (value >> 8) & 0xFF;
+    dst[2] = (value >> 16) & 0xFF;
+    dst[3] = value >> 24;
+}
+
+// Read a runtime parameter; returns false for an unknown id
+static bool param_get(uint8_t id, uint32_t *value) {
+    const display_params_t *p = &display_params_requested;
+    switch (id) {
+        case PARAM_DISPLAY_UPDATE_MS: *value = display_update_ms; break;
+        case PARAM_SPECTROGRAM_DEPTH: *value = p->spectrogram_depth; break;
+        case PARAM_PALETTE:           *value = p->palette; break;
+        case PARAM_GAIN_FLOOR:        *value = p->gain_floor; break;
+        case PARAM_DEBUG_VERBOSE:     *value = debug_verbose; break;
+        case PARAM_I2C_ADDRESS:       *value = current_i2c_address; break;
+        case PARAM_RENDER_MODE:       *value = p->render_mode; break;
+        case PARAM_FREQ_WARP:         *value = p->freq_warp; break;
+        case PARAM_INTERP_TIME:       *value = p->interp_time; break;
+        case PARAM_STATS_THRESHOLD:   *value = bin_stats_get_threshold(); break;
+        case PARAM_LOG_OUTPUT:        *value = log_get_output(); break;
+        case PARAM_STRESS_MODE:       *value = stress_mode; break;
+        case PARAM_HISTORY_ENABLE:    *value = flash_history_enabled(); break;
+        case PARAM_TIME_LEVEL:        *value = p->time_level; break;
+        case PARAM_SCROLL_MODE:       *value = p->scroll_mode; break;
+        case PARAM_CHANNELS:          *value = p->channels; break;
+        default: return false;
+    }
+    return true;
+}
+
+// Validate and apply a runtime parameter; returns 0 or a NAK error code.
+// Display settings are handed to Core 1 and take effect on its next frame.
+static uint8_t param_set(uint8_t id, uint32_t value) {
+    display_params_t *p = &display_params_requested;
+    switch (id) {
+        case PARAM_DISPLAY_UPDATE_MS:
+            if (value < DISPLAY_UPDATE_MS_MIN || value > DISPLAY_UPDATE_MS_MAX) return CONTROL_ERR_VALUE;
+            display_update_ms = value;
+            return 0;
+        case PARAM_DEBUG_VERBOSE:
+            if (value > 1) return CONTROL_ERR_VALUE;
+            if (value && !debug_verbose) {
+                irq_debug_count = 0;  // Log a fresh set of IRQ statuses
+            }
+            debug_verbose = value;
+            return 0;
+        case PARAM_I2C_ADDRESS:
+            if (value < I2C_ADDR_MIN || value > I2C_ADDR_MAX) return CONTROL_ERR_VALUE;
+            current_i2c_address = value;
+            address_changed = true;  // Applied by the main loop, as for the buttons
+            return 0;
+        case PARAM_STATS_THRESHOLD:
+            if (value > 255) return CONTROL_ERR_VALUE;
+            bin_stats_set_threshold(value);
+            return 0;
+        case PARAM_LOG_OUTPUT:
+            if (value > LOG_OUTPUT_BINARY) return CONTROL_ERR_VALUE;
+            log_set_output(value);
+            return 0;
+        case PARAM_STRESS_MODE:
+            if (value > 1) return CONTROL_ERR_VALUE;
+            stress_set_mode(value);
+            return 0;
+        case PARAM_HISTORY_ENABLE:
+            if (value > 1) return CONTROL_ERR_VALUE;
+            flash_history_set_enabled(value);
+            return 0;
+        case PARAM_SPECTROGRAM_DEPTH:
+            if (value < SPECTROGRAM_DEPTH_MIN || value > SPECTROGRAM_DEPTH) return CONTROL_ERR_VALUE;
+            p->spectrogram_depth = value;
+            break;
+        case PARAM_PALETTE:
+            if (value >= PALETTE_COUNT) return CONTROL_ERR_VALUE;
+            p->palette = value;
+            break;
+        case PARAM_GAIN_FLOOR:
+            if (value < 1 || value > 255) return CONTROL_ERR_VALUE;
+            p->gain_floor = value;
+            break;
+        case PARAM_RENDER_MODE:
+            if (value > RENDER_CUBIC) return CONTROL_ERR_VALUE;
+            p->render_mode = value;
+            break;
+        case PARAM_FREQ_WARP:
+            if (value > WARP_LOG) return CONTROL_ERR_VALUE;
+            p->freq_warp = value;
+            break;
+        case PARAM_INTERP_TIME:
+            if (value > 1) return CONTROL_ERR_VALUE;
+            p->interp_time = value;
+            break;
+        case PARAM_TIME_LEVEL:
+            if (value > PYRAMID_LEVELS) return CONTROL_ERR_VALUE;
+            p->time_level = value;
+            break;
+        case PARAM_SCROLL_MODE:
+            if (value > SCROLL_SUPPORTED) return CONTROL_ERR_VALUE;
+            p->scroll_mode = value;
+            break;
+        case PARAM_CHANNELS:
+            if (value < 1 || value > SPECTRO_CHANNELS) return CONTROL_ERR_VALUE;
+            p->channels = value;
+            break;
+        default:
+            return CONTROL_ERR_PARAM;
+    }
+    
+    display_params_pending = true;
+    redraw_requested = true;
+    return 0;
+}
+
+// Control channel command dispatch (called from control_poll on Core 0)
+void control_handle_command(uint8_t cmd, const uint8_t *payload, uint16_t len) {
+    uint8_t response[100];
+    uint32_t value;
+    
+    switch (cmd) {
+        case CMD_PING:
+            control_send_frame(cmd | CMD_RESPONSE, NULL, 0);
+            break;
+            
+        case CMD_GET_PARAM:
+            if (len != 1) {
+                control_send_nak(cmd, CONTROL_ERR_LENGTH);
+            } else if (!param_get(payload[0], &value)) {
+                control_send_nak(cmd, CONTROL_ERR_PARAM);
+            } else {
+                response[0] = payload[0];
+                put_u32_le(&response[1], value);
+                control_send_frame(cmd | CMD_RESPONSE, response, 5);
+            }
+            break;
+            
+        case CMD_SET_PARAM: {
+            if (len != 5) {
+                control_send_nak(cmd, CONTROL_ERR_LENGTH);
+                break;
+            }
+            value = payload[1] | (payload[2] << 8) | (payload[3] << 16) | ((uint32_t)payload[4] << 24);
+            uint8_t error = param_set(payload[0], value);
+            if (error != 0) {
+                control_send_nak(cmd, error);
+                break;
+            }
+            if (debug_verbose) LOG2(LOG_PARAM_SET, payload[0], value);
+            response[0] = payload[0];
+            put_u32_le(&response[1], value);
+            control_send_frame(cmd | CMD_RESPONSE, response, 5);
+            break;
+        }
+            
+        case CMD_GET_COUNTERS: {
+            uint32_t counters[] = {
+                packet_count,
+                invalid_header_count,
+                display_frames,
+                tiles_sent_last_frame,
+                bus_bytes_last_frame,
+                render_us_last_frame,
+                compose_ns_per_pixel,
+                (uint32_t)(spi_bytes_saved / 1024),
+                control_frames_ok,
+                control_crc_errors,
+                control_ring_overflows,
+                log_dropped_count(),
+                dma_wait_us_last_frame,
+                compose_busy_pct,
+                spi_busy_pct,
+                recovery_soft_count,
+                recovery_hard_count,
+                recovery_failed_count,
+                recovery_last_us,
+                recovery_max_us,
+            };
+            int n = sizeof(counters) / sizeof(counters[0]);
+            for (int i = 0; i < n; i++) {
+                put_u32_le(&response[i * 4], counters[i]);
+            }
+            control_send_frame(cmd | CMD_RESPONSE, response, n * 4);
+            break;
+        }
+            
+        case CMD_SCREENSHOT:
+            if (screenshot_row >= 0) {
+                control_send_nak(cmd, CONTROL_ERR_BUSY);
+                break;
+            }
+            response[0] = SPECTRO_W & 0xFF;
+            response[1] = SPECTRO_W >> 8;
+            response[2] = SPECTRO_H & 0xFF;
+            response[3] = SPECTRO_H >> 8;
+            control_send_frame(cmd | CMD_RESPONSE, response, 4);
+            screenshot_row = 0;
+            break;
+            
+        case CMD_HISTORY_INFO: {
+            flash_history_stats_t hs;
+            flash_history_get_stats(&hs);
+            uint32_t info[] = {
+                FLASH_HISTORY_SECTORS,
+                hs.sectors_used,
+                hs.boot_id,
+                hs.sectors_written,
+                hs.frames_written,
+                hs.frames_dropped,
+                hs.raw_bytes,
+                hs.encoded_bytes,
+                hs.write_us_max,
+                hs.laps,
+            };
+            int n = sizeof(info) / sizeof(info[0]);
+            for (int i = 0; i < n; i++) {
+                put_u32_le(&response[i * 4], info[i]);
+            }
+            control_send_frame(cmd | CMD_RESPONSE, response, n * 4);
+            break;
+        }
+            
+        case CMD_HISTORY_READ:
+            if (len != 8) {
+                control_send_nak(cmd, CONTROL_ERR_LENGTH);
+            } else if (history_frames_left > 0) {
+                control_send_nak(cmd, CONTROL_ERR_BUSY);
+            } else if ((payload[6] | payload[7]) == 0) {
+                control_send_nak(cmd, CONTROL_ERR_VALUE);  // No frames, no terminator
+            } else {
+                history_seek_boot = payload[0] | (payload[1] << 8);
+                history_seek_time = payload[2] | (payload[3] << 8) | (payload[4] << 16) | ((uint32_t)payload[5] << 24);
+                history_frames_left = payload[6] | (payload[7] << 8);
+                history_seek_pending = true;
+            }
+            break;
+            
+        case CMD_GET_FEATURES: {
+            speech_state_t speech;
+            speech_features_get(&speech);
+            response[0] = speech.features.energy_db_q8 & 0xFF;
+            response[1] = speech.features.energy_db_q8 >> 8;
+            response[2] = speech.features.centroid_hz & 0xFF;
+            response[3] = speech.features.centroid_hz >> 8;
+            response[4] = speech.features.flatness_q8 & 0xFF;
+            response[5] = speech.features.flatness_q8 >> 8;
+            response[6] = speech.noise_floor_db_q8 & 0xFF;
+            response[7] = speech.noise_floor_db_q8 >> 8;
+            response[8] = speech.voice;
+            put_u32_le(&response[9], speech.frames);
+            put_u32_le(&response[13], speech.voice_frames);
+            put_u32_le(&response[17], speech.voice_segments);
+            control_send_frame(cmd | CMD_RESPONSE, response, 21);
+            break;
+        }
+            
+        case CMD_GET_CHANNELS: {
+            // Memory per channel is the same for every channel: totals are
+            // this times the channel count
+            response[0] = SPECTRO_CHANNELS;
+            response[1] = split_panes;
+            put_u32_le(&response[2], CHANNEL_MEMORY_BYTES);
+            put_u32_le(&response[6], render_us_last_frame);
+            put_u32_le(&response[10], bus_bytes_last_frame);
+            put_u32_le(&response[14], invalid_channel_count);
+            int n = 18;
+            for (int c = 0; c < SPECTRO_CHANNELS; c++) {
+                put_u32_le(&response[n], channel_packets[c]);
+                put_u32_le(&response[n + 4], channel_lost[c]);
+                put_u32_le(&response[n + 8], channel_rate[c]);
+                put_u32_le(&response[n + 12], channel_render_us[c]);
+                put_u32_le(&response[n + 16], channel_bus_bytes[c]);
+                n += 20;
+            }
+            control_send_frame(cmd | CMD_RESPONSE, response, n);
+            break;
+        }
+            
+        default:
+            control_send_nak(cmd, CONTROL_ERR_UNKNOWN_CMD);
+            break;
+    }
+}
+
+// Live buffer row by age, for the pyramid check (Core 0, like process_packet)
+static const uint8_t *live_row(int age) {
+    return spectrogram_buffer[0][history_index(spectrogram_head[0], age)];
+}
+
+// Single-character commands outside a frame (kept for terminal use)
+void control_handle_text(char c) {
+    if (c == 's') {
+        bin_stats_snapshot_begin();
+    } else if (c == 'r') {
+        bin_stats_reset();
+        printf("Statistics reset\n");
+    } else if (c == 't') {
+        stress_set_mode(!stress_mode);
+    } else if (c == 'f') {
+        speech_features_benchmark_begin(NUM_FREQ_BINS, 10000);
+    } else if (c == 'p') {
+        uint32_t mismatches = history_pyramid_check(live_row, SPECTROGRAM_DEPTH);
+        printf("PYRAMID check %s\n", (mismatches == 0) ? "passed" : "FAILED");
+    } else if (c == 'c') {
+        printf("CHANNELS %u x %u B = %u B, %u panes, frame %u us %u B, invalid %u\n",
+               SPECTRO_CHANNELS, (unsigned)CHANNEL_MEMORY_BYTES,
+               (unsigned)(SPECTRO_CHANNELS * CHANNEL_MEMORY_BYTES), split_panes,
+               render_us_last_frame, bus_bytes_last_frame, invalid_channel_count);
+        for (int ch = 0; ch < SPECTRO_CHANNELS; ch++) {
+            printf("CH%d %u pkt %u lost %u pkt/s, pane %u us %u B\n", ch, channel_packets[ch],
+                   channel_lost[ch], channel_rate[ch], channel_render_us[ch], channel_bus_bytes[ch]);
+        }
+    }
+}
+
+// Send the next screenshot row: [u16 row][RGB565 little-endian pixels].
+// One row per loop pass keeps packet processing running in between.
+static void screenshot_poll(void) {
+    if (screenshot_row < 0) return;
+    
+    // Static for the same reason as in update_display: row table and pixel
+    // row are 2 KB together in profile 2, all of Core 0's stack. This
+    // copy belongs to Core 0.
+    static uint16_t pixels[SPECTRO_W];
+    static const uint8_t *rows[SPECTROGRAM_DEPTH];
+    history_rows_build(view_source, view_source_head(), rows);
+    compose_spectro_row(screenshot_row, rows, pixels);
+    
+    screenshot_frame[0] = screenshot_row & 0xFF;
+    screenshot_frame[1] = screenshot_row >> 8;
+    for (int x = 0; x < SPECTRO_W; x++) {
+        screenshot_frame[2 + x * 2] = pixels[x] & 0xFF;
+        screenshot_frame[3 + x * 2] = pixels[x] >> 8;
+    }
+    control_send_frame(CMD_SCREENSHOT | CMD_RESPONSE, screenshot_frame, sizeof(screenshot_frame));
+    
+    if (++screenshot_row >= SPECTRO_H) screenshot_row = -1;
+}
+
+// Send the next history frame: [u16 boot][u32 time_ms][bins]. An empty
+// frame ends the readout. Retries on the next pass while Core 1 writes flash.
+static void history_read_poll(void) {
+    if (history_frames_left <= 0) return;
+    
+    int result;
+    flash_history_frame_t frame;
+    if (history_seek_pending) {
+        result = flash_history_seek(history_seek_boot, history_seek_time);
+        if (result < 0) return;
+        history_seek_pending = false;
+        if (result > 0) result = flash_history_read(&frame);
+    } else {
+        result = flash_history_read(&frame);
+    }
+    if (result < 0) return;
+    
+    if (result == 0) {
+        history_frames_left = 0;
+        control_send_frame(CMD_HISTORY_READ | CMD_RESPONSE, NULL, 0);
+        return;
+    }
+    
+    uint8_t out[6 + NUM_FREQ_BINS];
+    out[0] = frame.boot_id & 0xFF;
+    out[1] = frame.boot_id >> 8;
+    put_u32_le(&out[2], frame.time_ms);
+    memcpy(&out[6], frame.bins, NUM_FREQ_BINS);
+    control_send_frame(CMD_HISTORY_READ | CMD_RESPONSE, out, sizeof(out));
+    
+    if (--history_frames_left == 0) {
+        control_send_frame(CMD_HISTORY_READ | CMD_RESPONSE, NULL, 0);
+    }
+}
+
 int main() {
     // Initialize USB serial
     stdio_init_all();
@@ -412,10 +1489,14 @@ int main() {
     printf("SPI Pins: SCLK=2, MOSI=3, MISO=4, CS=5, DC=6, RST=7\n");
     
     st7796_init();
-    printf("Display initialized\n");
+    printf("Display initialized (SPI %u MHz)\n", ST7796_SPI_HZ / 1000000);
+    
+    st7796_set_rotation(SPECTRO_ROTATION);
+    printf("Rotation set to %s (%dx%d)\n", (SPECTRO_ROTATION & 1) ? "landscape" : "portrait", SCREEN_W, SCREEN_H);
     
-    st7796_set_rotation(1); // Landscape mode (480x320)
-    printf("Rotation set to landscape\n");
+    // Register readback lets the watchdog verify a soft resync
+    display_readback = st7796_verify();
+    printf("Register readback %s\n", display_readback ? "OK" : "unavailable (recovery always resets)");
     
     st7796_fill_screen(COLOR_BLACK);
     printf("Screen cleared to black\n");
@@ -454,6 +1535,18 @@ int main() {
     gpio_set_irq_enabled(BTN_ADDR_DOWN, GPIO_IRQ_EDGE_FALL, true);
     printf("Button interrupts enabled\n");
     
+    // Speech feature tables (log2/exp2 lookups) and history quantizer
+    speech_features_init();
+    spectro_store_init();
+    
+    // Long-term history ring in the last 1 MB of flash
+    printf("\n--- Flash History ---\n");
+    flash_history_init(NULL, NUM_FREQ_BINS);
+    
+    // Initialize touch controller (zoom/pan of the spectrogram)
+    printf("\n--- Touch Initialization ---\n");
+    touch_init(NULL);
+    
     // Set initial I2C address
     current_i2c_address = I2C_BASE_ADDR;
     printf("\n--- I2C Slave Configuration ---\n");
@@ -507,7 +1600,7 @@ int main() {
     printf("RX FIFO threshold set\n");
     
     // Enable slave-mode interrupts
-    hw->intr_mask = (1 << 2) | (1 << 9);  // RX_FULL | STOP_DET
+    hw->intr_mask = (1 << 1) | (1 << 2) | (1 << 9);  // RX_OVER | RX_FULL | STOP_DET
     printf("Slave interrupts enabled\n");
     
     // Enable I2C
@@ -535,7 +1628,12 @@ int main() {
     printf("I2C slave ready on pins SDA=%d, SCL=%d\n", I2C_SDA, I2C_SCL);
     printf("Listening on address 0x%02X\n", current_i2c_address);
     printf("Waiting for packets (41 bytes: 0xAA + 40 bins)...\n");
-    printf("Use buttons on GPIO %d (up) and %d (down) to change address\n\n", BTN_ADDR_UP, BTN_ADDR_DOWN);
+    printf("Use buttons on GPIO %d (up) and %d (down) to change address\n", BTN_ADDR_UP, BTN_ADDR_DOWN);
+    printf("Serial commands: 's' = per-bin statistics snapshot, 'r' = reset statistics,\n");
+    printf("                 't' = toggle stress mode (pattern from stress_master),\n");
+    printf("                 'f' = speech feature benchmark, 'p' = time scale pyramid check,\n");
+    printf("                 'c' = channel counters\n");
+    printf("Binary control frames (0xA5 ...) set parameters, see README\n\n");
     
     // Display initial I2C address on screen
     char buffer[32];
@@ -547,10 +1645,10 @@ int main() {
     st7796_draw_string(5, 440, "500-5500 Hz (40 bins)", COLOR_GRAY, COLOR_BLACK, 1);
     
     // Launch Core 1 for display rendering
-    if (DEBUG_VERBOSE) printf("\n[Core 0] Launching Core 1 for display rendering...\n");
+    if (debug_verbose) printf("\n[Core 0] Launching Core 1 for display rendering...\n");
     multicore_launch_core1(core1_display_loop);
     sleep_ms(100);  // Give Core 1 time to start
-    if (DEBUG_VERBOSE) printf("[Core 0] Core 1 launched, I2C reception ready\n\n");
+    if (debug_verbose) printf("[Core 0] Core 1 launched, I2C reception ready\n\n");
     core1_last_beat_ms = to_ms_since_boot(get_absolute_time());
     
     // Main loop - Core 0 handles I2C reception only
@@ -563,7 +1661,7 @@ int main() {
         
         // Heartbeat every 5 seconds to confirm main loop is running
         if ((now - last_heartbeat) >= 5000) {
-            if (DEBUG_VERBOSE) printf("[Core 0 Heartbeat] %u packets received, loop_count=%u\n", packet_count, loop_count);
+            if (debug_verbose) LOG2(LOG_HEARTBEAT, packet_count, loop_count);
             last_heartbeat = now;
         }
         
@@ -575,7 +1673,7 @@ int main() {
         // Handle received packet
         if (packet_ready) {
             // Process received packet
-            if (DEBUG_VERBOSE) printf("Packet #%u received and queued for display\n", packet_count + 1);
+            if (debug_verbose) LOG1(LOG_PACKET_QUEUED, packet_count + 1);
             process_packet();
             
             // Reset for next packet
@@ -583,10 +1681,33 @@ int main() {
             rx_index = 0;
         }
 
+        // USB control channel, below packet handling: received bytes are
+        // buffered, then parsed. Statistics and screenshot output is sent one
+        // line/row per loop iteration, and the feature benchmark runs one
+        // slice, so packet processing keeps running
+        control_usb_task();
+        control_poll();
+        bin_stats_snapshot_poll();
+        speech_features_benchmark_poll();
+        screenshot_poll();
+        history_read_poll();
+        
+        // Deferred log records from both cores, formatted off the hot paths
+        log_drain();
+        
+        // Stress mode: one report per interval while a pattern sweep runs
+        if (stress_mode) {
+            stress_rx_counters_t rx = {
+                packet_count, invalid_header_count, aborted_transfer_count,
+                rx_fifo_overflows, rx_dropped_bytes,
+            };
+            stress_report_poll(now, &rx);
+        }
+
         // Core 1 watchdog: recover display if it stops updating
-        if (!core1_paused && core1_last_beat_ms != 0) {
+        if (!core1_paused && core1_last_beat_ms != 0 && !flash_history_writing()) {
             if ((now - core1_last_beat_ms) > CORE1_WATCHDOG_MS) {
-                printf("[Core 0] Display watchdog triggered, recovering Core 1\n");
+                LOG0(LOG_WATCHDOG_RECOVER);
                 recover_display();
             }
         }
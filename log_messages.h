@@ -0,0 +1,32 @@
+#ifndef LOG_MESSAGES_H
+#define LOG_MESSAGES_H
+
+// Deferred log message table: X(id, format). A record stores only the id and
+// up to LOG_MAX_ARGS 32-bit arguments; the format string is applied when the
+// record is drained (on the device in text mode, or by tools/log_decode.py).
+// IDs are positions in this list: append new messages at the end so captured
+// binary logs stay decodable.
+#define LOG_MESSAGES(X) \
+    X(LOG_DROPPED,          "[Log] %u records dropped on core %u") \
+    X(LOG_I2C_IRQ_STATUS,   "I2C IRQ #%u: status=0x%08X") \
+    X(LOG_PACKET_COMPLETE,  "Packet complete! [%u bytes]") \
+    X(LOG_INVALID_HEADER,   "Invalid header: 0x%02X (expected 0x%02X)") \
+    X(LOG_PACKET_QUEUED,    "Packet #%u received and queued for display") \
+    X(LOG_ADDRESS_CHANGED,  "I2C address changed to: 0x%02X") \
+    X(LOG_WATCHDOG_RECOVER, "[Core 0] Display watchdog triggered, recovering Core 1") \
+    X(LOG_CORE1_STARTED,    "[Core 1] Display renderer started") \
+    X(LOG_HEARTBEAT,        "[Core 0 Heartbeat] %u packets received, loop_count=%u") \
+    X(LOG_PARAM_SET,        "Parameter 0x%02X set to %u") \
+    X(LOG_VOICE_START,      "Voice start: %u dB (floor %u dB)") \
+    X(LOG_VOICE_END,        "Voice end: segment %u") \
+    X(LOG_INVALID_CHANNEL,  "Invalid channel: %u (%u configured)") \
+    X(LOG_DISPLAY_RECOVERED, "[Core 1] Display recovered: stage %u, %u us")
+
+#define LOG_MESSAGE_ID(id, format) id,
+typedef enum {
+    LOG_MESSAGES(LOG_MESSAGE_ID)
+    LOG_MESSAGE_COUNT
+} log_message_t;
+#undef LOG_MESSAGE_ID
+
+#endif // LOG_MESSAGES_H
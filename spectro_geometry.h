@@ -0,0 +1,103 @@
+#ifndef SPECTRO_GEOMETRY_H
+#define SPECTRO_GEOMETRY_H
+
+// Compile-time spectrogram geometry. The renderer's tile grid, clip limits
+// and status layout are derived from one profile here, so none of it is
+// computed at runtime. Select a profile with -DSPECTRO_GEOMETRY=<id>
+// (SPECTRO_GEOMETRY in CMake).
+//
+// Bins are fixed by the packet format (40 bins); profiles vary the history
+// depth (rows kept and shown), cell size, rotation and placement.
+#define SPECTRO_GEOMETRY_LANDSCAPE      0  // 480x320, 11x3 px cells, 100 rows (default)
+#define SPECTRO_GEOMETRY_PORTRAIT       1  // 320x480, 7x4 px cells, 100 rows
+#define SPECTRO_GEOMETRY_LANDSCAPE_DEEP 2  // 480x320, 11x1 px cells, 290 rows
+
+#ifndef SPECTRO_GEOMETRY
+#define SPECTRO_GEOMETRY SPECTRO_GEOMETRY_LANDSCAPE
+#endif
+
+#if SPECTRO_GEOMETRY == SPECTRO_GEOMETRY_LANDSCAPE
+// 40 bins × 11px = 440px, 100 samples × 3px = 300px (bottom 10px off the panel)
+#define SPECTRO_ROTATION 1     // st7796_set_rotation() value
+#define SCREEN_W 480
+#define SCREEN_H 320
+#define SPECTRO_DEPTH 100      // Rows of history
+#define SPECTRO_PIXEL_W 11     // Each frequency bin is 11 pixels wide
+#define SPECTRO_PIXEL_H 3      // Each time sample is 3 pixels tall
+#define SPECTRO_Y 30           // Start below the I2C address text
+#define STATUS_X 250           // Rate and refresh statistics, right of the address
+#define STATUS_Y 5
+#define LOAD_X 130             // U cpu/spi, under the time scale
+#define LOAD_Y 15
+#define SCROLL_SUPPORTED 1     // Panel lines run along x: hardware scroll is horizontal
+#elif SPECTRO_GEOMETRY == SPECTRO_GEOMETRY_PORTRAIT
+// 40 bins × 7px = 280px, 100 samples × 4px = 400px, statistics below
+#define SPECTRO_ROTATION 0
+#define SCREEN_W 320
+#define SCREEN_H 480
+#define SPECTRO_DEPTH 100
+#define SPECTRO_PIXEL_W 7
+#define SPECTRO_PIXEL_H 4
+#define SPECTRO_Y 30
+#define STATUS_X 5
+#define STATUS_Y 440
+#define LOAD_X (STATUS_X + 150)
+#define LOAD_Y STATUS_Y
+#define SCROLL_SUPPORTED 0     // Hardware scroll would move the header with the rows
+#elif SPECTRO_GEOMETRY == SPECTRO_GEOMETRY_LANDSCAPE_DEEP
+// 40 bins × 11px = 440px, 290 samples × 1px = 290px: every panel row below
+// the header holds a sample (4.8 s at 60 pkt/s)
+#define SPECTRO_ROTATION 1
+#define SCREEN_W 480
+#define SCREEN_H 320
+#define SPECTRO_DEPTH 290
+#define SPECTRO_PIXEL_W 11
+#define SPECTRO_PIXEL_H 1
+#define SPECTRO_Y 30
+#define STATUS_X 250
+#define STATUS_Y 5
+#define LOAD_X 130
+#define LOAD_Y 15
+#define SCROLL_SUPPORTED 1
+#else
+#error "Unknown SPECTRO_GEOMETRY"
+#endif
+
+// Speech feature strip right of the spectrogram (energy, centroid, flatness,
+// voice activity lanes; one pixel row per spectrogram pixel row), with bars
+// of the current values in the header above it
+#define FEATURE_STRIP_X (SPECTRO_W + 4)
+#define FEATURE_STRIP_W (SCREEN_W - FEATURE_STRIP_X)
+#define FEATURE_LANES 4
+#define FEATURE_LANE_W ((FEATURE_STRIP_W - (FEATURE_LANES - 1)) / FEATURE_LANES)
+
+// Horizontal-scroll waterfall (landscape only): time along x with the newest
+// row at the right edge, 40 bins × 8px up the full panel height. Columns
+// x < SCROLL_AREA_W scroll; the band right of them stays fixed and holds the
+// feature bars and status.
+#define SCROLL_AREA_W SPECTRO_W
+#define SCROLL_COLUMN_W 4      // Pixel columns per history row
+#define SCROLL_COLUMNS (SCROLL_AREA_W / SCROLL_COLUMN_W)
+#define SCROLL_BIN_H (SCREEN_H / 40)
+
+// Tiles hold 4 bins × 10 samples at 1x zoom, so 4x zoom cells stay one tile wide
+#define TILE_W (SPECTRO_PIXEL_W * 4)
+#define TILE_H (SPECTRO_PIXEL_H * 10)
+
+#if SPECTRO_DEPTH % 10 != 0
+#error "SPECTRO_DEPTH must be a whole number of tile rows"
+#endif
+
+// Rows of the spectrogram that land on the panel. Everything below is
+// clipped here once instead of in every fill and blit.
+#define SPECTRO_VISIBLE_H ((SPECTRO_Y + SPECTRO_H > SCREEN_H) ? SCREEN_H - SPECTRO_Y : SPECTRO_H)
+
+// Tile rows with at least one pixel row on the panel
+#define TILES_Y_VISIBLE ((SPECTRO_VISIBLE_H + TILE_H - 1) / TILE_H)
+
+// Visible pixel rows of tile row ty (0 for tiles entirely off the panel)
+#define TILE_VISIBLE_H(ty) \
+    (((ty) * TILE_H >= SPECTRO_VISIBLE_H) ? 0 : \
+     ((ty) * TILE_H + TILE_H > SPECTRO_VISIBLE_H) ? SPECTRO_VISIBLE_H - (ty) * TILE_H : TILE_H)
+
+#endif // SPECTRO_GEOMETRY_H
@@ -0,0 +1,689 @@
+#include "spectro_render.h"
+#include "st7796_driver.h"
+#include "pico/stdlib.h"
+#include <string.h>
+#include <math.h>
+
+// Display settings (latched by the application)
+render_mode_t render_mode = RENDER_MODE_DEFAULT;
+freq_warp_t freq_warp = FREQ_WARP_DEFAULT;
+bool interp_time = INTERP_TIME_DEFAULT;
+int spectrogram_depth = SPECTROGRAM_DEPTH;
+uint8_t palette_id = PALETTE_DEFAULT;
+
+// Tile hashes of the frame on the panel
+uint32_t tile_hash[TILES_Y][TILES_X];
+uint32_t tile_drawn_geom[TILES_Y][TILES_X];  // Geometry the tile's dividers were drawn with
+bool tile_hash_valid = false;  // Cleared whenever the panel contents are lost
+bool spectro_area_black = false;  // Panel was just cleared, black runs can be skipped
+
+// Zoom/pan view and its pixel span tables
+uint8_t view_freq_zoom = 1;
+uint8_t view_time_zoom = 1;
+int view_first_bin = 0;    // Leftmost visible bin
+int view_first_age = 0;    // Age of the top visible sample
+bool view_changed = true;  // Tables need rebuilding before the next frame
+static int16_t view_drag_x = 0;   // Drag distance not yet converted to whole cells
+static int16_t view_drag_y = 0;
+
+view_col_t view_cols[NUM_FREQ_BINS];
+view_row_t view_rows[SPECTROGRAM_DEPTH];
+int view_num_cols = 0;
+int view_num_rows = 0;
+
+// Per-tile ranges into view_cols/view_rows and tile geometry hashes
+uint8_t tile_col_first[TILES_X], tile_col_end[TILES_X];
+uint16_t tile_row_first[TILES_Y], tile_row_end[TILES_Y];
+uint32_t tile_geom_hash[TILES_Y][TILES_X];
+
+// Run-length span encoding of dirty tiles. Each bin column of a tile is split
+// into runs of equal color. A uniform run goes out as a single-color DMA fill
+// (no source buffer) when the buffering it avoids costs more bus cycles than
+// the extra window setup; shorter mixed runs are merged into one buffered blit.
+// Column dividers only change with the view geometry, so they are only drawn
+// on a full redraw or after a zoom/pan.
+#define SPAN_SETUP_CYCLES 600               // CASET/RASET/RAMWR + CS/DC toggles
+#define SPAN_PIXEL_CYCLES 3                 // Compose + DMA read per buffered pixel
+#define SPAN_FILL_MIN_PIXELS (SPAN_SETUP_CYCLES / SPAN_PIXEL_CYCLES)
+
+uint16_t band_pixels[RENDER_BANDS][TILE_W * TILE_H];
+uint16_t *tile_pixels = band_pixels[0];  // Band being composed
+static int band_index = 0;
+
+// Interpolating renderer tables
+uint8_t interp_x_bin[SPECTRO_W];      // Left tap bin for each pixel column
+uint8_t interp_x_frac[SPECTRO_W];     // Q8 weight towards the next bin
+uint16_t interp_y_age[SPECTRO_H];     // Sample age for each pixel row
+uint8_t interp_y_frac[SPECTRO_H];     // Q8 weight towards the next older sample
+static uint8_t interp_tile_bin_lo[TILES_X], interp_tile_bin_hi[TILES_X];  // Source taps per tile
+static uint16_t interp_tile_age_lo[TILES_Y], interp_tile_age_hi[TILES_Y];
+int16_t cubic_weights[256][4];        // Catmull-Rom taps per Q8 fraction (sum = 256)
+
+// Row reads, tile heights and fills of the specialized path, or of the
+// generic one when built with RENDER_GENERIC
+#if RENDER_GENERIC
+static const uint8_t (*generic_source)[STORE_ROW_BYTES];
+static int generic_head;
+#define HISTORY_ROW(rows, age) \
+    generic_source[(generic_head - 1 - (age) + SPECTROGRAM_DEPTH) % SPECTROGRAM_DEPTH]
+#define RENDER_TILES_Y TILES_Y
+#define RENDER_TILE_H(ty) TILE_H
+#define render_fill_rect st7796_fill_rect
+#else
+#define HISTORY_ROW(rows, age) (rows)[age]
+#define RENDER_TILES_Y TILES_Y_VISIBLE
+#define RENDER_TILE_H(ty) TILE_VISIBLE_H(ty)
+#define render_fill_rect st7796_fill_rect_unclipped
+#endif
+static bool cubic_weights_ready = false;
+
+// Stored code -> color lookup and the color scale it was built for
+uint16_t palette_lut[STORE_CODE_MAX + 1];
+static uint8_t palette_max_value = 0;
+static uint8_t palette_lut_id = 0xFF;
+
+// Per-frame counters
+uint32_t frame_bus_bytes;
+uint32_t frame_fills;
+uint32_t frame_blits;
+uint32_t frame_compose_us;       // Interpolating renderer only
+uint32_t frame_composed_pixels;
+uint64_t spi_bytes_saved = 0;
+
+// Map magnitude value to color (spectrogram gradient)
+// Black → Blue → Cyan → Green → Yellow → Red
+// RGB565: RRRRRGGGGGGBBBBB (5-bit R, 6-bit G, 5-bit B)
+uint16_t magnitude_to_color(uint8_t value, uint8_t max_value) {
+    if (value == 0 || max_value == 0) return COLOR_BLACK;  // 0x0000
+    
+    // Normalize to 0-255 range
+    int intensity = (value * 255) / max_value;
+    if (intensity > 255) intensity = 255;
+    if (intensity < 0) intensity = 0;
+    
+    int r, g, b;
+    
+    // Color gradient mapping (0-255 intensity range)
+    if (intensity < 51) {
+        // Black → Blue (0-20%)
+        r = 0;
+        g = 0;
+        b = (intensity * 255) / 51;  // 0 → 255
+    } else if (intensity < 102) {
+        // Blue → Cyan (20-40%)
+        r = 0;
+        g = ((intensity - 51) * 255) / 51;  // 0 → 255
+        b = 255;
+    } else if (intensity < 153) {
+        // Cyan → Green (40-60%)
+        r = 0;
+        g = 255;
+        b = 255 - ((intensity - 102) * 255) / 51;  // 255 → 0
+        if (b < 0) b = 0;
+    } else if (intensity < 204) {
+        // Green → Yellow (60-80%)
+        r = ((intensity - 153) * 255) / 51;  // 0 → 255
+        g = 255;
+        b = 0;
+    } else {
+        // Yellow → Red (80-100%)
+        r = 255;
+        g = 255 - ((intensity - 204) * 255) / 51;  // 255 → 0
+        if (g < 0) g = 0;
+        b = 0;
+    }
+    
+    // Bounds check all components
+    if (r < 0) r = 0; if (r > 255) r = 255;
+    if (g < 0) g = 0; if (g > 255) g = 255;
+    if (b < 0) b = 0; if (b > 255) b = 255;
+    
+    // Convert RGB888 (8-bit each) to RGB565 format
+    // RGB565: bit 15-11=R(5bits), bit 10-5=G(6bits), bit 4-0=B(5bits)
+    uint16_t r5 = (r >> 3) & 0x1F;  // 8-bit to 5-bit
+    uint16_t g6 = (g >> 2) & 0x3F;  // 8-bit to 6-bit
+    uint16_t b5 = (b >> 3) & 0x1F;  // 8-bit to 5-bit
+    
+    return (r5 << 11) | (g6 << 5) | b5;
+}
+
+// Map magnitude value to color with the selected palette
+uint16_t palette_color(uint8_t value, uint8_t max_value, uint8_t palette) {
+    if (palette == PALETTE_SPECTRUM) return magnitude_to_color(value, max_value);
+    if (value == 0 || max_value == 0) return COLOR_BLACK;
+    
+    int intensity = (value * 255) / max_value;
+    if (intensity > 255) intensity = 255;
+    
+    int r, g, b;
+    if (palette == PALETTE_GRAY) {
+        r = g = b = intensity;
+    } else {
+        // Hot: Black -> Red (0-33%) -> Yellow (33-67%) -> White
+        r = (intensity < 85) ? intensity * 3 : 255;
+        g = (intensity < 85) ? 0 : (intensity < 170) ? (intensity - 85) * 3 : 255;
+        b = (intensity < 170) ? 0 : (intensity - 170) * 3;
+        if (b > 255) b = 255;
+    }
+    
+    return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+}
+
+// Rebuild the code -> color lookup if the color scale or palette changed.
+// One entry per stored code, so 4-bit codes are dequantized here.
+void render_palette_update(uint8_t max_value) {
+    if (max_value == palette_max_value && palette_id == palette_lut_id) return;
+    for (int c = 0; c <= STORE_CODE_MAX; c++) {
+        palette_lut[c] = palette_color(store_dequant(c), max_value, palette_id);
+    }
+    palette_max_value = max_value;
+    palette_lut_id = palette_id;
+}
+
+// Row pointers of a history ring (live buffer or pyramid level) by age, for one frame. The
+// circular buffer is walked as two linear runs (head-1 down to 0, then
+// DEPTH-1 down to head), so the renderer never takes a modulo per row.
+void history_rows_build(const uint8_t (*source)[STORE_ROW_BYTES], int current_head, const uint8_t **rows) {
+#if RENDER_GENERIC
+    generic_source = source;  // Rows are looked up by modulo instead
+    generic_head = current_head;
+#endif
+    int age = 0;
+    for (int i = current_head - 1; i >= 0; i--) {
+        rows[age++] = source[i];
+    }
+    for (int i = SPECTROGRAM_DEPTH - 1; i >= current_head; i--) {
+        rows[age++] = source[i];
+    }
+}
+
+// Visible samples at the current time zoom
+static inline int view_rows_for_zoom(uint8_t time_zoom) {
+    int rows = spectrogram_depth / time_zoom;
+    return (rows < 1) ? 1 : rows;
+}
+
+static void view_clamp(void) {
+    int max_first_bin = NUM_FREQ_BINS - NUM_FREQ_BINS / view_freq_zoom;
+    int max_first_age = spectrogram_depth - view_rows_for_zoom(view_time_zoom);
+    
+    if (view_first_bin < 0) view_first_bin = 0;
+    if (view_first_bin > max_first_bin) view_first_bin = max_first_bin;
+    if (view_first_age < 0) view_first_age = 0;
+    if (view_first_age > max_first_age) view_first_age = max_first_age;
+}
+
+// Frequency warp used to space pixel columns (bin centers are 500 + 125n Hz)
+static float warp_forward(float hz) {
+    switch (freq_warp) {
+        case WARP_MEL: return 2595.0f * log10f(1.0f + hz / 700.0f);
+        case WARP_LOG: return logf(hz);
+        default:       return hz;
+    }
+}
+
+static float warp_inverse(float w) {
+    switch (freq_warp) {
+        case WARP_MEL: return 700.0f * (powf(10.0f, w / 2595.0f) - 1.0f);
+        case WARP_LOG: return expf(w);
+        default:       return w;
+    }
+}
+
+// Build the x->(bin, weight) and y->(age, weight) tables for the current view.
+// Runs once per geometry change, so float math and divisions are fine here.
+static void interp_build(void) {
+    if (!cubic_weights_ready) {
+        for (int f = 0; f < 256; f++) {
+            float t = f / 256.0f;
+            float t2 = t * t;
+            float t3 = t2 * t;
+            cubic_weights[f][0] = (int16_t)lroundf(128.0f * (-t3 + 2.0f * t2 - t));
+            cubic_weights[f][1] = (int16_t)lroundf(128.0f * (3.0f * t3 - 5.0f * t2 + 2.0f));
+            cubic_weights[f][2] = (int16_t)lroundf(128.0f * (-3.0f * t3 + 4.0f * t2 + t));
+            cubic_weights[f][3] = 256 - cubic_weights[f][0] - cubic_weights[f][1] - cubic_weights[f][2];
+        }
+        cubic_weights_ready = true;
+    }
+    
+    // Frequency axis: visible bins span [first - 0.5, first + cols - 0.5] in bin units
+    float f_lo = 500.0f + 125.0f * (view_first_bin - 0.5f);
+    float f_hi = 500.0f + 125.0f * (view_first_bin + view_num_cols - 0.5f);
+    float w_lo = warp_forward(f_lo);
+    float w_hi = warp_forward(f_hi);
+    
+    for (int x = 0; x < SPECTRO_W; x++) {
+        float hz = warp_inverse(w_lo + (w_hi - w_lo) * (x + 0.5f) / SPECTRO_W);
+        float pos = (hz - 500.0f) / 125.0f;
+        if (pos < 0.0f) pos = 0.0f;
+        if (pos > NUM_FREQ_BINS - 1) pos = NUM_FREQ_BINS - 1;
+        
+        int q8 = (int)(pos * 256.0f);
+        interp_x_bin[x] = q8 >> 8;
+        interp_x_frac[x] = q8 & 0xFF;
+    }
+    
+    // Time axis: blocks per sample, or linear between samples
+    for (int y = 0; y < SPECTRO_H; y++) {
+        if (interp_time) {
+            float pos = view_first_age + (y + 0.5f) * view_num_rows / SPECTRO_H - 0.5f;
+            if (pos < 0.0f) pos = 0.0f;
+            if (pos > spectrogram_depth - 1) pos = spectrogram_depth - 1;
+            
+            int q8 = (int)(pos * 256.0f);
+            interp_y_age[y] = q8 >> 8;
+            interp_y_frac[y] = q8 & 0xFF;
+        } else {
+            interp_y_age[y] = view_first_age + view_row_at(y, view_num_rows);
+            interp_y_frac[y] = 0;
+        }
+    }
+    
+    // Source taps each tile reads (cubic uses bin-1 .. bin+2)
+    int tap_lo = (render_mode == RENDER_CUBIC) ? 1 : 0;
+    int tap_hi = (render_mode == RENDER_CUBIC) ? 2 : 1;
+    for (int tx = 0; tx < TILES_X; tx++) {
+        int lo = interp_x_bin[tx * TILE_W] - tap_lo;
+        int hi = interp_x_bin[tx * TILE_W + TILE_W - 1] + tap_hi;
+        interp_tile_bin_lo[tx] = (lo < 0) ? 0 : lo;
+        interp_tile_bin_hi[tx] = (hi > NUM_FREQ_BINS - 1) ? NUM_FREQ_BINS - 1 : hi;
+    }
+    for (int ty = 0; ty < TILES_Y; ty++) {
+        int lo = interp_y_age[ty * TILE_H];
+        int hi = interp_y_age[ty * TILE_H + TILE_H - 1] + (interp_time ? 1 : 0);
+        interp_tile_age_lo[ty] = lo;
+        interp_tile_age_hi[ty] = (hi > spectrogram_depth - 1) ? spectrogram_depth - 1 : hi;
+    }
+    
+    // Every pixel depends on the whole mapping, so all tiles share one geometry
+    uint32_t hash = 2166136261u;
+    hash = fnv1a(hash, render_mode | (freq_warp << 4) | (interp_time << 8));
+    hash = fnv1a(hash, (view_first_bin << 16) | view_first_age);
+    hash = fnv1a(hash, (view_freq_zoom << 8) | view_time_zoom);
+    hash = fnv1a(hash, spectrogram_depth);
+    for (int ty = 0; ty < TILES_Y; ty++) {
+        for (int tx = 0; tx < TILES_X; tx++) {
+            tile_geom_hash[ty][tx] = hash;
+        }
+    }
+}
+
+// Rebuild the bin/sample -> pixel span tables for the current zoom and pan
+static void view_build(void) {
+    int col_w = SPECTRO_PIXEL_W * view_freq_zoom;
+    
+    view_clamp();
+    view_num_cols = NUM_FREQ_BINS / view_freq_zoom;
+    view_num_rows = view_rows_for_zoom(view_time_zoom);
+    
+    for (int c = 0; c < view_num_cols; c++) {
+        view_cols[c].bin = view_first_bin + c;
+        view_cols[c].x = c * col_w;
+        view_cols[c].w = col_w;
+    }
+    // Rows share the height evenly; with a reduced depth some are one pixel taller
+    for (int r = 0; r < view_num_rows; r++) {
+        int y0 = (r * SPECTRO_H + view_num_rows - 1) / view_num_rows;
+        int y1 = ((r + 1) * SPECTRO_H + view_num_rows - 1) / view_num_rows;
+        view_rows[r].age = view_first_age + r;
+        view_rows[r].y = SPECTRO_Y + y0;
+        view_rows[r].h = y1 - y0;
+    }
+    
+    // Columns and rows overlapping each tile
+    for (int tx = 0; tx < TILES_X; tx++) {
+        tile_col_first[tx] = (tx * TILE_W) / col_w;
+        tile_col_end[tx] = ((tx + 1) * TILE_W + col_w - 1) / col_w;
+    }
+    for (int ty = 0; ty < TILES_Y; ty++) {
+        tile_row_first[ty] = view_row_at(ty * TILE_H, view_num_rows);
+        tile_row_end[ty] = view_row_at((ty + 1) * TILE_H - 1, view_num_rows) + 1;
+    }
+    
+    if (render_mode != RENDER_BLOCKS) {
+        interp_build();
+        return;
+    }
+    
+    // Geometry hash: where dividers and sample boundaries fall inside a tile
+    for (int ty = 0; ty < TILES_Y; ty++) {
+        for (int tx = 0; tx < TILES_X; tx++) {
+            uint32_t hash = 2166136261u;
+            for (int c = tile_col_first[tx]; c < tile_col_end[tx]; c++) {
+                hash = fnv1a(hash, view_cols[c].x - tx * TILE_W);
+            }
+            for (int r = tile_row_first[ty]; r < tile_row_end[ty]; r++) {
+                hash = fnv1a(hash, view_rows[r].y - (SPECTRO_Y + ty * TILE_H));
+            }
+            tile_geom_hash[ty][tx] = fnv1a(hash, (col_w << 8) | view_num_rows);
+        }
+    }
+}
+
+// Touch gestures arrive in landscape coordinates; portrait profiles swap
+// the axes back (resolved at compile time)
+static inline void gesture_to_screen(touch_gesture_t *gesture) {
+#if (SPECTRO_ROTATION & 1) == 0
+    int16_t t = gesture->x;
+    gesture->x = gesture->y;
+    gesture->y = t;
+    t = gesture->dx;
+    gesture->dx = gesture->dy;
+    gesture->dy = t;
+#else
+    (void)gesture;
+#endif
+}
+
+// Apply a touch gesture to the view; returns true if the view changed.
+// Tap cycles the zoom (1x/2x/4x) around the touched cell, drag pans.
+bool view_apply_gesture(touch_gesture_t *gesture) {
+    gesture_to_screen(gesture);
+    int col_w = SPECTRO_PIXEL_W * view_freq_zoom;
+    if (view_num_rows == 0) return false;  // Tables not built yet
+    int row_h = SPECTRO_H / view_num_rows;  // Average row pitch
+    
+    if (gesture->type == TOUCH_GESTURE_TAP) {
+        if (gesture->y < SPECTRO_Y || gesture->y >= SPECTRO_Y + SPECTRO_H) return false;
+        if (gesture->x >= SPECTRO_W) return false;  // Feature strip
+        int px = gesture->x;
+        int py = gesture->y - SPECTRO_Y;
+        int bin = view_first_bin + px / col_w;
+        int age = view_first_age + view_row_at(py, view_num_rows);
+        
+        uint8_t zoom = (view_freq_zoom >= VIEW_MAX_ZOOM) ? 1 : view_freq_zoom * 2;
+        view_freq_zoom = zoom;
+        view_time_zoom = zoom;
+        
+        // Keep the touched cell under the finger
+        view_first_bin = bin - px / (SPECTRO_PIXEL_W * zoom);
+        view_first_age = age - view_row_at(py, view_rows_for_zoom(zoom));
+        view_drag_x = 0;
+        view_drag_y = 0;
+        view_changed = true;
+        return true;
+    }
+    
+    if (gesture->type == TOUCH_GESTURE_DRAG) {
+        view_drag_x += gesture->dx;
+        view_drag_y += gesture->dy;
+        int dbins = view_drag_x / col_w;
+        int dages = view_drag_y / row_h;
+        view_drag_x -= dbins * col_w;
+        view_drag_y -= dages * row_h;
+        
+        // Content follows the finger
+        int old_bin = view_first_bin;
+        int old_age = view_first_age;
+        view_first_bin -= dbins;
+        view_first_age -= dages;
+        view_clamp();
+        
+        if (view_first_bin == old_bin && view_first_age == old_age) return false;
+        view_changed = true;
+        return true;
+    }
+    
+    if (gesture->type == TOUCH_GESTURE_DRAG_END) {
+        view_drag_x = 0;
+        view_drag_y = 0;
+    }
+    return false;
+}
+
+// FNV-1a hash of a tile's geometry, source cells and the active color scale
+static uint32_t tile_compute_hash(int tx, int ty, const uint8_t **rows, uint8_t max_value) {
+#if RENDER_GENERIC
+    (void)rows;  // HISTORY_ROW reads the ring itself
+#endif
+    uint32_t hash = fnv1a(tile_geom_hash[ty][tx], max_value | (palette_id << 8));
+    
+    if (render_mode != RENDER_BLOCKS) {
+        for (int age = interp_tile_age_lo[ty]; age <= interp_tile_age_hi[ty]; age++) {
+            const uint8_t *samples = HISTORY_ROW(rows, age);
+            for (int bin = interp_tile_bin_lo[tx]; bin <= interp_tile_bin_hi[tx]; bin++) {
+                hash = fnv1a(hash, store_get(samples, bin));
+            }
+        }
+        return hash;
+    }
+    
+    for (int r = tile_row_first[ty]; r < tile_row_end[ty]; r++) {
+        const uint8_t *samples = HISTORY_ROW(rows, view_rows[r].age);
+        for (int c = tile_col_first[tx]; c < tile_col_end[tx]; c++) {
+            hash = fnv1a(hash, store_get(samples, view_cols[c].bin));
+        }
+    }
+    return hash;
+}
+
+// SPI bytes needed to send one tile (bottom row is clipped by the panel)
+static inline uint32_t tile_spi_bytes(int ty) {
+    if (TILE_VISIBLE_H(ty) == 0) return 0;
+    return ST7796_WINDOW_SETUP_BYTES + (uint32_t)TILE_W * TILE_VISIBLE_H(ty) * 2;
+}
+
+// Send the composed band as a clipped block and compose into the next one
+void band_send(int x, int y, int w, int h) {
+    st7796_draw_bitmap_async(x, y, w, h, tile_pixels);
+#if RENDER_BANDS == 1
+    st7796_dma_wait();
+#endif
+    band_index = (band_index + 1) % RENDER_BANDS;
+    tile_pixels = band_pixels[band_index];
+    frame_blits++;
+}
+
+// Send the composed pixels for rows [y0, y1) of a column as one blit window
+static void span_flush_blit(int x, int w, int y0, int y1) {
+    if (y0 < 0 || y1 <= y0) return;
+    band_send(x, y0, w, y1 - y0);
+    frame_bus_bytes += ST7796_WINDOW_SETUP_BYTES + w * (y1 - y0) * 2;
+}
+
+// Encode one dirty tile into fills and blits; returns SPI bytes sent.
+// The tile is clipped to the panel by the geometry profile, so every
+// rectangle below is on screen and goes out without further checks.
+static uint32_t send_tile_spans(int tx, int ty, const uint8_t **rows, bool skip_black, bool draw_dividers) {
+#if RENDER_GENERIC
+    (void)rows;  // HISTORY_ROW reads the ring itself
+#endif
+    uint32_t bytes_before = frame_bus_bytes;
+    int tile_x0 = tx * TILE_W;
+    int tile_x1 = tile_x0 + TILE_W;
+    int tile_y0 = SPECTRO_Y + ty * TILE_H;
+    int tile_y1 = tile_y0 + RENDER_TILE_H(ty);
+    
+    for (int c = tile_col_first[tx]; c < tile_col_end[tx]; c++) {
+        const view_col_t *col = &view_cols[c];
+        
+        // Column divider distinguishes bins
+        if (draw_dividers && col->x >= tile_x0) {
+            render_fill_rect(col->x, tile_y0, 1, tile_y1 - tile_y0, COLOR_DARKGRAY);
+            frame_bus_bytes += ST7796_WINDOW_SETUP_BYTES + (tile_y1 - tile_y0) * 2;
+        }
+        
+        // Cell content, clipped to the tile
+        int x0 = (col->x + 1 > tile_x0) ? col->x + 1 : tile_x0;
+        int x1 = (col->x + col->w < tile_x1) ? col->x + col->w : tile_x1;
+        int w = x1 - x0;
+        if (w <= 0) continue;
+        
+        int blit_y0 = -1;  // Top of the pending blit window
+        int r = tile_row_first[ty];
+        while (r < tile_row_end[ty]) {
+            // Newest sample at top, oldest at bottom, wrapping circularly
+            uint16_t color = palette_lut[store_get(HISTORY_ROW(rows, view_rows[r].age), col->bin)];
+            int run_end = r + 1;
+            while (run_end < tile_row_end[ty] &&
+                   palette_lut[store_get(HISTORY_ROW(rows, view_rows[run_end].age), col->bin)] == color) {
+                run_end++;
+            }
+            
+            int y0 = (view_rows[r].y > tile_y0) ? view_rows[r].y : tile_y0;
+            if (y0 >= tile_y1) break;  // Remaining rows are below the panel
+            int y1 = view_rows[run_end - 1].y + view_rows[run_end - 1].h;
+            if (y1 > tile_y1) y1 = tile_y1;
+            int run_pixels = w * (y1 - y0);
+            bool skip = skip_black && color == COLOR_BLACK;
+            
+            if (skip || run_pixels >= SPAN_FILL_MIN_PIXELS) {
+                span_flush_blit(x0, w, blit_y0, y0);
+                blit_y0 = -1;
+                if (!skip) {
+                    render_fill_rect(x0, y0, w, y1 - y0, color);
+                    frame_bus_bytes += ST7796_WINDOW_SETUP_BYTES + run_pixels * 2;
+                    frame_fills++;
+                }
+            } else {
+                // Compose the run into the blit buffer
+                if (blit_y0 < 0) blit_y0 = y0;
+                uint16_t *dst = &tile_pixels[(y0 - blit_y0) * w];
+                for (int i = 0; i < run_pixels; i++) {
+                    dst[i] = color;
+                }
+            }
+            r = run_end;
+        }
+        span_flush_blit(x0, w, blit_y0, tile_y1);
+    }
+    
+    return frame_bus_bytes - bytes_before;
+}
+
+// Compose pixels [x0, x0 + w) of one spectrogram pixel row with the
+// interpolating renderer, reading source bins [bin_lo, bin_hi] only
+static void interp_compose_row(int py, int x0, int w, int bin_lo, int bin_hi, const uint8_t **rows, uint16_t *out) {
+#if RENDER_GENERIC
+    (void)rows;  // HISTORY_ROW reads the ring itself
+#endif
+    const uint8_t *xb = &interp_x_bin[x0];
+    const uint8_t *xf = &interp_x_frac[x0];
+    
+    // Source line, padded by one bin below and two above
+    int16_t line[NUM_FREQ_BINS + 3];
+    int16_t *bins = &line[1];
+    
+    const uint8_t *a = HISTORY_ROW(rows, interp_y_age[py]);
+    int f = interp_y_frac[py];
+    if (f != 0) {
+        const uint8_t *b = HISTORY_ROW(rows, interp_y_age[py] + 1);
+        for (int i = bin_lo; i <= bin_hi; i++) {
+            int va = store_get(a, i);
+            bins[i] = va + (((store_get(b, i) - va) * f) >> 8);
+        }
+    } else {
+        for (int i = bin_lo; i <= bin_hi; i++) {
+            bins[i] = store_get(a, i);
+        }
+    }
+    bins[-1] = bins[0];  // Edge taps repeat the outermost bins
+    bins[NUM_FREQ_BINS] = bins[NUM_FREQ_BINS - 1];
+    bins[NUM_FREQ_BINS + 1] = bins[NUM_FREQ_BINS - 1];
+    
+    if (render_mode == RENDER_CUBIC) {
+        for (int x = 0; x < w; x++) {
+            const int16_t *t = &bins[xb[x] - 1];
+            const int16_t *wt = cubic_weights[xf[x]];
+            int v = (wt[0] * t[0] + wt[1] * t[1] + wt[2] * t[2] + wt[3] * t[3]) >> 8;
+            if (v < 0) v = 0;
+            if (v > STORE_CODE_MAX) v = STORE_CODE_MAX;
+            out[x] = palette_lut[v];
+        }
+    } else {
+        for (int x = 0; x < w; x++) {
+            const int16_t *t = &bins[xb[x]];
+            out[x] = palette_lut[t[0] + (((t[1] - t[0]) * xf[x]) >> 8)];
+        }
+    }
+}
+
+// Compose one tile with the interpolating renderer and blit it; returns SPI bytes
+static uint32_t send_tile_interp(int tx, int ty, const uint8_t **rows) {
+    uint32_t start_us = time_us_32();
+    int tile_h = RENDER_TILE_H(ty);  // Rows below the panel are not composed
+    
+    for (int j = 0; j < tile_h; j++) {
+        int py = ty * TILE_H + j;
+        uint16_t *out = &tile_pixels[j * TILE_W];
+        
+        // Rows sharing a sample (no time interpolation) repeat the previous row
+        if (j > 0 && interp_y_age[py] == interp_y_age[py - 1] && interp_y_frac[py] == interp_y_frac[py - 1]) {
+            memcpy(out, out - TILE_W, TILE_W * sizeof(uint16_t));
+            continue;
+        }
+        interp_compose_row(py, tx * TILE_W, TILE_W, interp_tile_bin_lo[tx], interp_tile_bin_hi[tx],
+                           rows, out);
+    }
+    frame_compose_us += time_us_32() - start_us;
+    frame_composed_pixels += TILE_W * tile_h;
+    
+    band_send(tx * TILE_W, SPECTRO_Y + ty * TILE_H, TILE_W, tile_h);
+    frame_bus_bytes += tile_spi_bytes(ty);
+    return tile_spi_bytes(ty);
+}
+
+// Compose one full-width pixel row of the spectrogram as it appears on the
+// panel (used by the screenshot readout on Core 0). Reads the view tables
+// without locking, so a row can tear if Core 1 changes the view meanwhile.
+void compose_spectro_row(int py, const uint8_t **rows, uint16_t *out) {
+    if (render_mode != RENDER_BLOCKS) {
+        interp_compose_row(py, 0, SPECTRO_W, 0, NUM_FREQ_BINS - 1, rows, out);
+        return;
+    }
+    
+    int num_rows = view_num_rows;
+    if (num_rows == 0) {
+        memset(out, 0, SPECTRO_W * sizeof(uint16_t));
+        return;
+    }
+    const uint8_t *samples = HISTORY_ROW(rows, view_rows[view_row_at(py, num_rows)].age);
+    for (int c = 0; c < view_num_cols; c++) {
+        const view_col_t *col = &view_cols[c];
+        uint16_t color = palette_lut[store_get(samples, col->bin)];
+        out[col->x] = COLOR_DARKGRAY;
+        for (int x = col->x + 1; x < col->x + col->w; x++) {
+            out[x] = color;
+        }
+    }
+}
+
+// Row layout: send only the tiles whose geometry, source cells or color
+// scale changed. Returns tiles sent.
+uint32_t render_tiles(const uint8_t **rows, uint8_t max_value) {
+    if (view_changed) {
+        view_build();
+        view_changed = false;
+    }
+    
+    bool full_redraw = !tile_hash_valid;
+    bool skip_black = full_redraw && spectro_area_black;
+    
+    uint32_t tiles_sent = 0;
+    for (int ty = 0; ty < RENDER_TILES_Y; ty++) {
+        for (int tx = 0; tx < TILES_X; tx++) {
+            uint32_t hash = tile_compute_hash(tx, ty, rows, max_value);
+            
+            if (!full_redraw && hash == tile_hash[ty][tx]) {
+                spi_bytes_saved += tile_spi_bytes(ty);
+                continue;
+            }
+            
+            bool draw_dividers = full_redraw || tile_drawn_geom[ty][tx] != tile_geom_hash[ty][tx];
+            tile_hash[ty][tx] = hash;
+            tile_drawn_geom[ty][tx] = tile_geom_hash[ty][tx];
+            
+            uint32_t sent = (render_mode == RENDER_BLOCKS)
+                ? send_tile_spans(tx, ty, rows, skip_black, draw_dividers)
+                : send_tile_interp(tx, ty, rows);
+            if (sent < tile_spi_bytes(ty)) {
+                spi_bytes_saved += tile_spi_bytes(ty) - sent;
+            }
+            tiles_sent++;
+        }
+    }
+    
+    tile_hash_valid = true;
+    spectro_area_black = false;
+    return tiles_sent;
+}
@@ -0,0 +1,177 @@
+#ifndef SPECTRO_RENDER_H
+#define SPECTRO_RENDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "spectro_geometry.h"
+#include "spectro_store.h"
+#include "touch_driver.h"
+
+// Row layout renderer: the zoom/pan view tables, the tile-hash partial
+// refresh with its span encoder and interpolating renderer, the palette
+// lookup and the composition bands. Runs on Core 1; the screenshot readout
+// on Core 0 composes rows through the same tables. Scroll and split-screen
+// layouts live in the application and share the bands, palette and frame
+// counters declared here.
+//
+// Nothing here touches the hardware directly: pixels go through
+// st7796_driver.h and time through time_us_32(), so the module also builds
+// against the host test harness (test/).
+
+// Bins are fixed by the packet format
+#define NUM_FREQ_BINS STORE_BINS
+#define SPECTROGRAM_DEPTH SPECTRO_DEPTH
+
+// Spectrogram layout: cell size, rotation and placement come from the
+// compile-time geometry profile (spectro_geometry.h)
+#define SPECTRO_W (NUM_FREQ_BINS * SPECTRO_PIXEL_W)
+#define SPECTRO_H (SPECTROGRAM_DEPTH * SPECTRO_PIXEL_H)
+
+// Tile-hash partial refresh: the spectrogram is split into tiles of
+// 4 bins × 10 samples at 1x zoom (44x30px in landscape). A hash of each
+// tile's geometry, source cells and color scale is kept from the previous
+// frame; only changed tiles are re-sent.
+#define TILES_X (SPECTRO_W / TILE_W)
+#define TILES_Y (SPECTRO_H / TILE_H)
+#define NUM_TILES (TILES_X * TILES_Y)
+
+// Zoom/pan view transform (touch driven). Visible bins and samples are mapped
+// to pixel spans through tables that are rebuilt only when the view changes.
+// Zoom factors are powers of two up to 4x so cells stay aligned to tiles.
+#define VIEW_MAX_ZOOM 4
+
+// Composition bands: one cell column (span encoder), one whole tile
+// (interpolating renderer) or one pane row (split screen). 4x zoom cells are
+// exactly one tile wide. A composed band goes out in the background
+// (st7796_draw_bitmap_async) and composing moves on to the other band, so
+// palette lookups for band N+1 overlap the DMA of band N. The driver keeps
+// one transfer in flight and finishes it before the next command, so the
+// band being composed was sent two transfers ago and is free. Build with
+// -DRENDER_BANDS=1 to send every band synchronously for comparison.
+#ifndef RENDER_BANDS
+#define RENDER_BANDS 2
+#endif
+#if RENDER_BANDS < 1 || RENDER_BANDS > 2
+#error "RENDER_BANDS must be 1 or 2"
+#endif
+
+// Geometry specialization: rows are read through the per-frame table from
+// history_rows_build and tiles are clipped to the panel at compile time.
+// Build with -DRENDER_GENERIC=1 for the generic path it replaced, for
+// comparison: a modulo into the ring for every row read, every tile row
+// composed and sent whole, and fills clipped again by the driver. The
+// generic lookups follow the ring of the last history_rows_build() call,
+// which Core 0's screenshot readout also makes, so that build is for the
+// host tests only.
+#ifndef RENDER_GENERIC
+#define RENDER_GENERIC 0
+#endif
+
+typedef struct {
+    uint8_t bin;
+    int16_t x, w;
+} view_col_t;
+
+typedef struct {
+    uint16_t age;  // 0 = newest sample
+    int16_t y, h;
+} view_row_t;
+
+// Interpolating renderer. Instead of hard bin-wide blocks, every pixel column is
+// mapped to a source bin and a Q8 weight through tables built once per view
+// geometry, so the inner loop is lookups, multiplies and shifts only.
+// An optional mel or log warp of the frequency axis goes through the same table.
+typedef enum {
+    RENDER_BLOCKS = 0,  // Nearest bin, bin-wide cells with dividers
+    RENDER_LINEAR,      // Linear interpolation along frequency
+    RENDER_CUBIC,       // Catmull-Rom interpolation along frequency
+} render_mode_t;
+
+typedef enum {
+    WARP_LINEAR = 0,    // Bins spaced evenly (125 Hz per bin)
+    WARP_MEL,
+    WARP_LOG,
+} freq_warp_t;
+
+#define RENDER_MODE_DEFAULT RENDER_BLOCKS
+#define FREQ_WARP_DEFAULT WARP_LINEAR
+#define INTERP_TIME_DEFAULT false  // Also interpolate between samples
+
+// Stored code -> color lookup, rebuilt only when the color scale changes
+typedef enum {
+    PALETTE_SPECTRUM = 0,  // Black -> Blue -> Cyan -> Green -> Yellow -> Red
+    PALETTE_GRAY,
+    PALETTE_HOT,           // Black -> Red -> Yellow -> White
+    PALETTE_COUNT,
+} palette_t;
+
+#define PALETTE_DEFAULT PALETTE_SPECTRUM
+
+// Display settings, latched by the application at the start of a frame
+extern render_mode_t render_mode;
+extern freq_warp_t freq_warp;
+extern bool interp_time;
+extern int spectrogram_depth;  // Samples shown (newest first)
+extern uint8_t palette_id;
+
+// Tile state
+extern uint32_t tile_hash[TILES_Y][TILES_X];
+extern uint32_t tile_drawn_geom[TILES_Y][TILES_X];
+extern bool tile_hash_valid;     // Cleared whenever the panel contents are lost
+extern bool spectro_area_black;  // Panel was just cleared, black runs can be skipped
+
+// View state and tables
+extern uint8_t view_freq_zoom;
+extern uint8_t view_time_zoom;
+extern int view_first_bin;
+extern int view_first_age;
+extern bool view_changed;
+extern view_col_t view_cols[NUM_FREQ_BINS];
+extern view_row_t view_rows[SPECTROGRAM_DEPTH];
+extern int view_num_cols;
+extern int view_num_rows;
+extern uint8_t tile_col_first[TILES_X], tile_col_end[TILES_X];
+extern uint16_t tile_row_first[TILES_Y], tile_row_end[TILES_Y];
+extern uint32_t tile_geom_hash[TILES_Y][TILES_X];
+
+// Interpolation tables
+extern uint8_t interp_x_bin[SPECTRO_W];
+extern uint8_t interp_x_frac[SPECTRO_W];
+extern uint16_t interp_y_age[SPECTRO_H];
+extern uint8_t interp_y_frac[SPECTRO_H];
+extern int16_t cubic_weights[256][4];
+
+// Palette and composition bands
+extern uint16_t palette_lut[STORE_CODE_MAX + 1];
+extern uint16_t band_pixels[RENDER_BANDS][TILE_W * TILE_H];
+extern uint16_t *tile_pixels;  // Band being composed
+
+// Per-frame counters (reset by the caller before each frame)
+extern uint32_t frame_bus_bytes;
+extern uint32_t frame_fills;
+extern uint32_t frame_blits;
+extern uint32_t frame_compose_us;
+extern uint32_t frame_composed_pixels;
+extern uint64_t spi_bytes_saved;
+
+static inline uint32_t fnv1a(uint32_t hash, uint32_t value) {
+    return (hash ^ value) * 16777619u;
+}
+
+// Pixel row (0 = top of the spectrogram) -> visible row index. Row r starts
+// at ceil(r * SPECTRO_H / num_rows), so this is the exact inverse.
+static inline int view_row_at(int py, int num_rows) {
+    return py * num_rows / SPECTRO_H;
+}
+
+// Function prototypes
+uint16_t magnitude_to_color(uint8_t value, uint8_t max_value);
+uint16_t palette_color(uint8_t value, uint8_t max_value, uint8_t palette);
+void render_palette_update(uint8_t max_value);
+void history_rows_build(const uint8_t (*source)[STORE_ROW_BYTES], int current_head, const uint8_t** rows);
+bool view_apply_gesture(touch_gesture_t* gesture);
+void band_send(int x, int y, int w, int h);
+uint32_t render_tiles(const uint8_t** rows, uint8_t max_value);
+void compose_spectro_row(int py, const uint8_t** rows, uint16_t* out);
+
+#endif // SPECTRO_RENDER_H
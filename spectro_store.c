@@ -0,0 +1,35 @@
+#include "spectro_store.h"
+#include <string.h>
+
+#if SPECTRO_STORE_BITS == 4
+// Code q covers magnitudes q^2 .. (q+1)^2 - 1: fine steps near the noise
+// floor, coarse ones near full scale, like the eye reads a color ramp
+uint8_t store_quant[256];
+uint8_t store_dequant_table[16];
+#endif
+
+void spectro_store_init(void) {
+#if SPECTRO_STORE_BITS == 4
+    uint8_t q = 0;
+    for (int v = 0; v < 256; v++) {
+        if (q < 15 && v >= (q + 1) * (q + 1)) q++;
+        store_quant[v] = q;
+    }
+    for (int c = 0; c < 16; c++) {
+        int lo = c * c;
+        int hi = (c == 15) ? 255 : (c + 1) * (c + 1) - 1;
+        store_dequant_table[c] = (lo + hi + 1) / 2;
+    }
+#endif
+}
+
+// Store one received frame (Core 0, per packet)
+void store_pack_row(const uint8_t* bins, uint8_t* row) {
+#if SPECTRO_STORE_BITS == 4
+    for (int i = 0; i < STORE_ROW_BYTES; i++) {
+        row[i] = store_quant[bins[2 * i]] | (store_quant[bins[2 * i + 1]] << 4);
+    }
+#else
+    memcpy(row, bins, STORE_ROW_BYTES);
+#endif
+}
@@ -0,0 +1,68 @@
+#ifndef SPECTRO_STORE_H
+#define SPECTRO_STORE_H
+
+#include <stdint.h>
+
+// Row format of the spectrogram history (live buffer and pyramid levels).
+// Select with -DSPECTRO_STORE_BITS=<bits> (SPECTRO_STORE_BITS in CMake):
+//   8: one byte per bin, codes are the received magnitudes (default)
+//   4: square-root companded codes, two bins per byte (bin 2k in the low
+//      nibble), half the memory per row
+// Renderers work on codes: the palette lookup is indexed by code and built
+// from store_dequant(), so dequantization costs nothing per pixel.
+#ifndef SPECTRO_STORE_BITS
+#define SPECTRO_STORE_BITS 8
+#endif
+
+#define STORE_BINS 40
+#define STORE_ROW_BYTES (STORE_BINS * SPECTRO_STORE_BITS / 8)
+#define STORE_CODE_MAX ((1 << SPECTRO_STORE_BITS) - 1)
+
+#if SPECTRO_STORE_BITS != 8 && SPECTRO_STORE_BITS != 4
+#error "SPECTRO_STORE_BITS must be 8 or 4"
+#endif
+
+#if SPECTRO_STORE_BITS == 4
+extern uint8_t store_quant[256];
+extern uint8_t store_dequant_table[16];
+#endif
+
+// Code of one bin
+static inline uint8_t store_get(const uint8_t* row, int bin) {
+#if SPECTRO_STORE_BITS == 4
+    return (row[bin >> 1] >> ((bin & 1) << 2)) & 0x0F;
+#else
+    return row[bin];
+#endif
+}
+
+// Magnitude a code stands for (center of its quantization step)
+static inline uint8_t store_dequant(uint8_t code) {
+#if SPECTRO_STORE_BITS == 4
+    return store_dequant_table[code];
+#else
+    return code;
+#endif
+}
+
+// Largest code of a row, a byte (two bins) at a time
+static inline uint8_t store_row_max(const uint8_t* row) {
+    uint8_t max_code = 0;
+    for (int i = 0; i < STORE_ROW_BYTES; i++) {
+#if SPECTRO_STORE_BITS == 4
+        uint8_t lo = row[i] & 0x0F;
+        uint8_t hi = row[i] >> 4;
+        if (lo > max_code) max_code = lo;
+        if (hi > max_code) max_code = hi;
+#else
+        if (row[i] > max_code) max_code = row[i];
+#endif
+    }
+    return max_code;
+}
+
+// Function prototypes
+void spectro_store_init(void);
+void store_pack_row(const uint8_t* bins, uint8_t* row);
+
+#endif // SPECTRO_STORE_H
@@ -0,0 +1,174 @@
+#include "speech_features.h"
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// Q8 lookup tables, built once at init (float is fine there)
+static uint8_t log2_frac_q8[256];   // log2(1 + i/256)
+static uint16_t log2_u8_q8[256];    // log2(b), zero bins count as 1
+static uint32_t exp2_neg_q16[256];  // 2^(-i/256)
+
+static speech_state_t state;
+static uint16_t hangover = 0;
+
+// log2(x) in Q8 from the leading bit and an 8-bit mantissa lookup
+static inline int32_t log2_q8(uint32_t x) {
+    if (x == 0) return 0;
+    int k = 31 - __builtin_clz(x);
+    uint32_t frac = (k >= 8) ? (x >> (k - 8)) : (x << (8 - k));
+    return k * 256 + log2_frac_q8[frac & 0xFF];
+}
+
+void speech_features_init(void) {
+    for (int i = 0; i < 256; i++) {
+        log2_frac_q8[i] = (uint8_t)lroundf(256.0f * log2f(1.0f + i / 256.0f));
+        exp2_neg_q16[i] = (uint32_t)lroundf(65536.0f * exp2f(-i / 256.0f));
+    }
+    for (int b = 0; b < 256; b++) {
+        log2_u8_q8[b] = log2_q8(b);
+    }
+    memset(&state, 0, sizeof(state));
+    hangover = 0;
+}
+
+// Features of one frame. One pass over the bins (four sums, one table
+// lookup per bin), then two divisions and three table lookups.
+void speech_features_compute(const uint8_t* bins, int num_bins, speech_features_t* out) {
+    uint32_t sum = 0;
+    uint32_t sum_weighted = 0;
+    uint32_t sum_sq = 0;
+    uint32_t sum_log = 0;
+    for (int i = 0; i < num_bins; i++) {
+        uint32_t b = bins[i];
+        sum += b;
+        sum_weighted += i * b;
+        sum_sq += b * b;
+        sum_log += log2_u8_q8[b];
+    }
+
+    if (sum == 0) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+
+    // Energy: 10*log10(x) = log2(x) * 3.0103 (771/256)
+    int32_t log2_energy = log2_q8(sum_sq);
+    out->energy_db_q8 = (log2_energy * 771 + 128) >> 8;
+
+    // Centroid in Q8 bins, then Hz
+    uint32_t centroid_q8 = (sum_weighted << 8) / sum;
+    out->centroid_hz = FEATURE_BIN0_HZ + ((FEATURE_BIN_HZ * centroid_q8 + 128) >> 8);
+
+    // Flatness of the power spectrum p = b^2:
+    // log2(geometric mean / arithmetic mean) = mean(log2 p) - log2(mean p) <= 0
+    int32_t mean_log_power = (int32_t)(2 * sum_log) / num_bins;
+    int32_t log_mean_power = log2_energy - log2_q8(num_bins);
+    int32_t drop = log_mean_power - mean_log_power;
+    if (drop < 0) drop = 0;
+    out->flatness_q8 = ((drop >> 8) >= 24) ? 0 : (exp2_neg_q16[drop & 0xFF] >> (drop >> 8)) >> 8;
+}
+
+// Voice activity with hangover; returns true if the flag changed
+static bool vad_step(speech_state_t* s, uint16_t* hang) {
+    int32_t energy = s->features.energy_db_q8;
+    int32_t floor_db = s->noise_floor_db_q8;
+    s->frames++;
+
+    if (s->frames == 1) floor_db = energy;
+    bool active = energy > 0 &&
+                  energy > floor_db + VAD_MARGIN_DB_Q8 &&
+                  s->features.flatness_q8 < VAD_FLATNESS_MAX_Q8;
+
+    // Noise floor follows quieter frames quickly and creeps up otherwise,
+    // so it recovers from a level change within seconds
+    if (energy < floor_db) {
+        floor_db -= ((floor_db - energy) >> VAD_FLOOR_FALL_SHIFT) + 1;
+    } else {
+        floor_db += VAD_FLOOR_RISE_Q8;
+    }
+    if (floor_db < 0) floor_db = 0;
+    if (floor_db > 0xFFFF) floor_db = 0xFFFF;
+    s->noise_floor_db_q8 = floor_db;
+
+    if (active) {
+        *hang = VAD_HANGOVER_FRAMES;
+    } else if (*hang > 0) {
+        (*hang)--;
+    }
+    bool voice = active || *hang > 0;
+    bool changed = voice != s->voice;
+    if (voice) {
+        s->voice_frames++;
+        if (changed) s->voice_segments++;
+    }
+    s->voice = voice;
+    return changed;
+}
+
+// Compute the features of one packet and update voice activity (Core 0,
+// per packet). Returns true when the voice flag changed.
+bool speech_features_update(const uint8_t* bins, int num_bins) {
+    speech_features_compute(bins, num_bins, &state.features);
+    return vad_step(&state, &hangover);
+}
+
+void speech_features_get(speech_state_t* out) {
+    *out = state;
+}
+
+// Benchmark of compute + VAD over synthetic frames, run in slices of
+// FEATURE_BENCH_SLICE packets from the main loop so packet reception is
+// never held up for long. Runs on a scratch state, so the live flag and
+// counters are untouched; only time inside the slices is counted.
+#define FEATURE_BENCH_SLICE 100
+
+static uint8_t bench_frames[8][256];
+static speech_state_t bench_state;
+static uint16_t bench_hangover;
+static int bench_bins;
+static int bench_left = 0;  // Packets still to run (0 = idle)
+static int bench_iterations;
+static uint32_t bench_us;
+
+// Start a benchmark of the given number of packets; the result is printed
+// by the speech_features_benchmark_poll() call that finishes it
+bool speech_features_benchmark_begin(int num_bins, int iterations) {
+    if (bench_left > 0 || iterations <= 0) return false;
+
+    uint32_t seed = 12345;
+    for (int f = 0; f < 8; f++) {
+        for (int i = 0; i < num_bins; i++) {
+            seed = seed * 1103515245u + 12345u;
+            bench_frames[f][i] = (f & 1) ? (seed >> 24) : (seed >> 26);
+        }
+    }
+    memset(&bench_state, 0, sizeof(bench_state));
+    bench_hangover = 0;
+    bench_bins = num_bins;
+    bench_iterations = bench_left = iterations;
+    bench_us = 0;
+    return true;
+}
+
+// Run the next slice; returns true while the benchmark is still running
+bool speech_features_benchmark_poll(void) {
+    if (bench_left == 0) return false;
+
+    int n = (bench_left < FEATURE_BENCH_SLICE) ? bench_left : FEATURE_BENCH_SLICE;
+    int done = bench_iterations - bench_left;
+    uint32_t start_us = time_us_32();
+    for (int i = done; i < done + n; i++) {
+        speech_features_compute(bench_frames[i & 7], bench_bins, &bench_state.features);
+        vad_step(&bench_state, &bench_hangover);
+    }
+    bench_us += time_us_32() - start_us;
+    bench_left -= n;
+    if (bench_left > 0) return true;
+
+    uint32_t ns = (uint32_t)((uint64_t)bench_us * 1000 / bench_iterations);
+    uint32_t mhz = clock_get_hz(clk_sys) / 1000000;
+    printf("FEATURES %d bins: %u ns/packet (%u cycles at %u MHz)\n", bench_bins, ns, ns * mhz / 1000, mhz);
+    return false;
+}
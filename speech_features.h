@@ -0,0 +1,48 @@
+#ifndef SPEECH_FEATURES_H
+#define SPEECH_FEATURES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Per-packet speech indicators for running next to a recognizer: frame
+// energy, spectral centroid, spectral flatness and a voice activity flag.
+// Everything per packet is integer math over the bins: sums, table
+// lookups for log2/exp2 and two divisions, so the cost is a fixed
+// function of the bin count (see speech_features_benchmark_begin()).
+#define FEATURE_BIN0_HZ 500  // Center of bin 0
+#define FEATURE_BIN_HZ 125   // Bin spacing
+
+// Voice activity: frame energy above the tracked noise floor by a margin,
+// with a spectrum less flat than noise. The flag stays on for a hangover
+// after the last active frame so short pauses inside words do not split
+// a segment.
+#define VAD_MARGIN_DB_Q8 (9 * 256)      // Energy above the noise floor
+#define VAD_FLATNESS_MAX_Q8 160         // 0.62: flatter frames count as noise
+#define VAD_HANGOVER_FRAMES 20          // ~330 ms at 60 pkt/s
+#define VAD_FLOOR_RISE_Q8 8             // Floor creep per frame (0.03 dB)
+#define VAD_FLOOR_FALL_SHIFT 3          // Floor follows quieter frames by 1/8
+
+typedef struct {
+    uint16_t energy_db_q8;    // 10*log10(sum of squared bins), Q8 dB (0 for silence)
+    uint16_t centroid_hz;     // Magnitude-weighted mean frequency (0 for silence)
+    uint16_t flatness_q8;     // Geometric / arithmetic mean of power, Q8 (256 = white)
+} speech_features_t;
+
+typedef struct {
+    speech_features_t features;  // Last packet
+    uint16_t noise_floor_db_q8;
+    bool voice;
+    uint32_t frames;
+    uint32_t voice_frames;
+    uint32_t voice_segments;
+} speech_state_t;
+
+// Function prototypes
+void speech_features_init(void);
+void speech_features_compute(const uint8_t* bins, int num_bins, speech_features_t* out);
+bool speech_features_update(const uint8_t* bins, int num_bins);
+void speech_features_get(speech_state_t* out);
+bool speech_features_benchmark_begin(int num_bins, int iterations);
+bool speech_features_benchmark_poll(void);
+
+#endif // SPEECH_FEATURES_H
@@ -2,7 +2,7 @@
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
-#include <stdio.h>
+#include "hardware/dma.h"
 #include <string.h>
 
 // SPI and control pins
@@ -17,8 +17,11 @@
 // ST7796 commands
 #define ST7796_NOP        0x00
 #define ST7796_SWRESET    0x01
+#define ST7796_RDDMADCTL  0x0B
+#define ST7796_RDDCOLMOD  0x0C
 #define ST7796_SLPIN      0x10
 #define ST7796_SLPOUT     0x11
+#define ST7796_NORON      0x13
 #define ST7796_INVOFF     0x20
 #define ST7796_INVON      0x21
 #define ST7796_DISPOFF    0x28
@@ -26,14 +29,27 @@
 #define ST7796_CASET      0x2A
 #define ST7796_RASET      0x2B
 #define ST7796_RAMWR      0x2C
+#define ST7796_VSCRDEF    0x33
 #define ST7796_MADCTL     0x36
+#define ST7796_VSCRSADD   0x37
 #define ST7796_COLMOD     0x3A
 #define ST7796_CSCON      0xF0
 
+// Register reads are specified for a slower clock than writes
+#define ST7796_READ_HZ (6 * 1000 * 1000)
+#define ST7796_COLMOD_16BIT 0x55
+
 // Display dimensions
 static uint16_t _width = LCD_WIDTH;
 static uint16_t _height = LCD_HEIGHT;
 static uint8_t _rotation = 0;
+static uint8_t _madctl = 0x48;  // Last MADCTL sent by st7796_set_rotation()
+
+// DMA channel for pixel bursts (claimed once in st7796_init)
+static int dma_chan = -1;
+static uint16_t dma_fill_color;
+static bool dma_pending = false;      // Background burst started, CS still low
+static uint32_t dma_wait_total_us = 0;  // CPU time spent waiting for bursts
 
 // Simple 5x7 font bitmap
 static const uint8_t font5x7[][5] = {
@@ -123,8 +139,10 @@ static inline void rst_low() {
     gpio_put(PIN_RST, 0);
 }
 
-// Send command to display
+// Send command to display. Every window, fill and blit starts with a
+// command, so a background pixel burst is finished here first.
 static void st7796_write_command(uint8_t cmd) {
+    st7796_dma_wait();
     dc_command();
     cs_select();
     spi_write_blocking(SPI_PORT, &cmd, 1);
@@ -167,18 +185,25 @@ static void st7796_set_addr_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16
     st7796_write_command(ST7796_RAMWR);
 }
 
-// Initialize display
+// Initialize display. Also used by the watchdog's hard recovery, so it
+// prints nothing (USB stdio can block); the caller reports the outcome.
 void st7796_init(void) {
-    printf("ST7796: Initializing SPI...\n");
     // Initialize SPI
-    spi_init(SPI_PORT, 32 * 1000 * 1000); // 32 MHz
+    if (dma_pending) {
+        dma_channel_abort(dma_chan);  // Re-initialization drops a burst in flight
+        dma_pending = false;
+    }
+    spi_init(SPI_PORT, ST7796_SPI_HZ); // 32 MHz
     gpio_set_function(PIN_SCLK, GPIO_FUNC_SPI);
     gpio_set_function(PIN_MOSI, GPIO_FUNC_SPI);
     gpio_set_function(PIN_MISO, GPIO_FUNC_SPI);
-    printf("ST7796: SPI initialized at 32 MHz\n");
+    
+    // Claim a DMA channel for pixel bursts (kept across re-initialization)
+    if (dma_chan < 0) {
+        dma_chan = dma_claim_unused_channel(true);
+    }
 
     // Initialize control pins
-    printf("ST7796: Initializing control pins (CS=%d, DC=%d, RST=%d)\n", PIN_CS, PIN_DC, PIN_RST);
     gpio_init(PIN_CS);
     gpio_init(PIN_DC);
     gpio_init(PIN_RST);
@@ -189,45 +214,35 @@ void st7796_init(void) {
     cs_deselect();
     rst_high();
     sleep_ms(10);
-    printf("ST7796: Control pins configured\n");
 
     // Hardware reset
-    printf("ST7796: Performing hardware reset...\n");
     rst_low();
     sleep_ms(20);
     rst_high();
     sleep_ms(120);
-    printf("ST7796: Hardware reset complete\n");
 
     // Software reset
-    printf("ST7796: Sending software reset command...\n");
     st7796_write_command(ST7796_SWRESET);
     sleep_ms(150);
 
     // Sleep out
-    printf("ST7796: Waking display from sleep...\n");
     st7796_write_command(ST7796_SLPOUT);
     sleep_ms(120);
 
     // Interface Pixel Format: 16-bit color
-    printf("ST7796: Setting 16-bit color mode...\n");
     st7796_write_command(ST7796_COLMOD);
-    st7796_write_data(0x55); // 16-bit/pixel
+    st7796_write_data(ST7796_COLMOD_16BIT); // 16-bit/pixel
 
     // Memory Access Control
-    printf("ST7796: Configuring memory access...\n");
     st7796_write_command(ST7796_MADCTL);
     st7796_write_data(0x48); // Row/column address order
 
     // Display Inversion Off
-    printf("ST7796: Configuring inversion...\n");
     st7796_write_command(ST7796_INVOFF);
 
     // Display ON
-    printf("ST7796: Turning display ON...\n");
     st7796_write_command(ST7796_DISPON);
     sleep_ms(10);
-    printf("ST7796: Display initialization complete!\n");
 }
 
 // Set display rotation
@@ -237,26 +252,27 @@ void st7796_set_rotation(uint8_t rotation) {
     
     switch (_rotation) {
         case 0: // Portrait
-            st7796_write_data(0x48);
+            _madctl = 0x48;
             _width = LCD_WIDTH;
             _height = LCD_HEIGHT;
             break;
         case 1: // Landscape
-            st7796_write_data(0x28);
+            _madctl = 0x28;
             _width = LCD_HEIGHT;
             _height = LCD_WIDTH;
             break;
         case 2: // Portrait inverted
-            st7796_write_data(0x88);
+            _madctl = 0x88;
             _width = LCD_WIDTH;
             _height = LCD_HEIGHT;
             break;
         case 3: // Landscape inverted
-            st7796_write_data(0xE8);
+            _madctl = 0xE8;
             _width = LCD_HEIGHT;
             _height = LCD_WIDTH;
             break;
     }
+    st7796_write_data(_madctl);
 }
 
 // Fill entire screen with color
@@ -273,25 +289,219 @@ void st7796_draw_pixel(int16_t x, int16_t y, uint16_t color) {
     st7796_write_data_buf(data, 2);
 }
 
-// Fill a rectangle
+// Switch the SPI frame size (8-bit for commands, 16-bit for pixel bursts)
+static inline void spi_set_bits(uint bits) {
+    spi_set_format(SPI_PORT, bits, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+}
+
+// Start streaming 16-bit pixels to the panel through DMA.
+// With read_increment=false the single value at src is repeated (solid fill).
+static void st7796_dma_start(const uint16_t* src, uint32_t count, bool read_increment) {
+    dma_channel_config c = dma_channel_get_default_config(dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, read_increment);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(SPI_PORT, true));
+    dma_channel_configure(dma_chan, &c, &spi_get_hw(SPI_PORT)->dr, src, count, true);
+}
+
+// Wait for the burst to end, let the last pixel leave the shifter, then
+// discard RX data and overrun
+static void st7796_dma_finish(void) {
+    uint32_t start_us = time_us_32();
+    dma_channel_wait_for_finish_blocking(dma_chan);
+    while (spi_is_busy(SPI_PORT)) tight_loop_contents();
+    while (spi_is_readable(SPI_PORT)) (void)spi_get_hw(SPI_PORT)->dr;
+    spi_get_hw(SPI_PORT)->icr = SPI_SSPICR_RORIC_BITS;
+    dma_wait_total_us += time_us_32() - start_us;
+}
+
+// Stream pixels and wait for them
+static void st7796_dma_pixels(const uint16_t* src, uint32_t count, bool read_increment) {
+    st7796_dma_start(src, count, read_increment);
+    st7796_dma_finish();
+}
+
+// Finish a burst started by st7796_draw_bitmap_async() (no-op when idle)
+void st7796_dma_wait(void) {
+    if (!dma_pending) return;
+    dma_pending = false;
+    st7796_dma_finish();
+    spi_set_bits(8);
+    cs_deselect();
+}
+
+// Total time callers were blocked on pixel DMA, synchronous or not
+uint32_t st7796_dma_wait_us(void) {
+    return dma_wait_total_us;
+}
+
+// Read a one-byte register over MISO (the panel sends a dummy byte first)
+static uint8_t st7796_read_register(uint8_t cmd) {
+    uint8_t data[2] = {0, 0};
+    st7796_dma_wait();
+    spi_set_baudrate(SPI_PORT, ST7796_READ_HZ);
+    dc_command();
+    cs_select();
+    spi_write_blocking(SPI_PORT, &cmd, 1);
+    dc_data();
+    spi_read_blocking(SPI_PORT, 0x00, data, 2);
+    cs_deselect();
+    spi_set_baudrate(SPI_PORT, ST7796_SPI_HZ);
+    return data[1];
+}
+
+// True if the panel reads back the orientation and pixel format last sent.
+// Fails on modules without MISO wired, so callers check it once at boot.
+bool st7796_verify(void) {
+    return st7796_read_register(ST7796_RDDMADCTL) == _madctl &&
+           st7796_read_register(ST7796_RDDCOLMOD) == ST7796_COLMOD_16BIT;
+}
+
+// Soft resync after a stalled transfer, without the reset and its sleeps:
+// drop the burst in flight and the SPI FIFOs, return CS/DC to idle so the
+// panel sees a command boundary, then re-send the pixel format, orientation
+// and normal display mode. Frame memory is kept. Returns st7796_verify().
+bool st7796_resync(void) {
+    if (dma_chan >= 0) {
+        dma_channel_abort(dma_chan);
+    }
+    dma_pending = false;
+    while (spi_is_busy(SPI_PORT)) tight_loop_contents();
+    while (spi_is_readable(SPI_PORT)) (void)spi_get_hw(SPI_PORT)->dr;
+    spi_get_hw(SPI_PORT)->icr = SPI_SSPICR_RORIC_BITS;
+    spi_set_bits(8);
+    cs_deselect();
+    dc_command();
+    
+    st7796_write_command(ST7796_NOP);
+    st7796_write_command(ST7796_COLMOD);
+    st7796_write_data(ST7796_COLMOD_16BIT);
+    st7796_set_rotation(_rotation);
+    st7796_write_command(ST7796_NORON);
+    st7796_write_command(ST7796_DISPON);
+    return st7796_verify();
+}
+
+// Fill a rectangle (single-color DMA fill, no source buffer)
 void st7796_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
     if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    if (w <= 0 || h <= 0) return;
     if (x + w > _width) w = _width - x;
     if (y + h > _height) h = _height - y;
     
+    st7796_fill_rect_unclipped(x, y, w, h, color);
+}
+
+// Fill a rectangle the caller has already clipped to the screen (w, h > 0).
+// The fill runs in the background: its only source is dma_fill_color, which
+// is not touched again before the next command has waited for it.
+void st7796_fill_rect_unclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
     st7796_set_addr_window(x, y, x + w - 1, y + h - 1);
     
-    uint8_t data[2] = {color >> 8, color & 0xFF};
+    dma_fill_color = color;
     dc_data();
     cs_select();
+    spi_set_bits(16);
+    st7796_dma_start(&dma_fill_color, (uint32_t)w * h, false);
+    dma_pending = true;
+}
+
+// Blit a w*h block of RGB565 pixels (row-major, native endianness)
+void st7796_draw_bitmap(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pixels) {
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+    if (w <= 0 || h <= 0) return;
+    
+    // Clip against the screen; keep the source stride for clipped widths
+    int16_t stride = w;
+    if (x + w > _width) w = _width - x;
+    if (y + h > _height) h = _height - y;
+    
+    if (w == stride) {
+        st7796_draw_bitmap_unclipped(x, y, w, h, pixels);
+        return;
+    }
+    
+    st7796_set_addr_window(x, y, x + w - 1, y + h - 1);
     
-    for (int32_t i = 0; i < w * h; i++) {
-        spi_write_blocking(SPI_PORT, data, 2);
+    dc_data();
+    cs_select();
+    spi_set_bits(16);
+    for (int16_t row = 0; row < h; row++) {
+        st7796_dma_pixels(pixels + row * stride, w, true);
     }
+    spi_set_bits(8);
+    cs_deselect();
+}
+
+// Blit a block the caller has already clipped to the screen (w, h > 0)
+void st7796_draw_bitmap_unclipped(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pixels) {
+    st7796_set_addr_window(x, y, x + w - 1, y + h - 1);
     
+    dc_data();
+    cs_select();
+    spi_set_bits(16);
+    st7796_dma_pixels(pixels, (uint32_t)w * h, true);
+    spi_set_bits(8);
     cs_deselect();
 }
 
+// Start a blit of a clipped block and return while DMA sends it. The pixels
+// must stay untouched until the next driver call or st7796_dma_wait().
+void st7796_draw_bitmap_async(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pixels) {
+    st7796_set_addr_window(x, y, x + w - 1, y + h - 1);
+    
+    dc_data();
+    cs_select();
+    spi_set_bits(16);
+    st7796_dma_start(pixels, (uint32_t)w * h, true);
+    dma_pending = true;
+}
+
+// Write whole frame-memory lines (LCD_WIDTH pixels each, the panel's own
+// scan direction) starting at line, with the column order of rotation 0.
+// In landscape (rotation 1) a line is one screen column and pixel 0 lands at
+// the bottom, so column-major data goes out as a single window.
+void st7796_write_lines(uint16_t line, uint16_t count, const uint16_t* pixels) {
+    st7796_write_command(ST7796_MADCTL);
+    st7796_write_data(0x48);
+    st7796_set_addr_window(0, line, LCD_WIDTH - 1, line + count - 1);
+    
+    dc_data();
+    cs_select();
+    spi_set_bits(16);
+    st7796_dma_pixels(pixels, (uint32_t)count * LCD_WIDTH, true);
+    spi_set_bits(8);
+    cs_deselect();
+    
+    st7796_set_rotation(_rotation);  // Restore the screen orientation
+}
+
+// Hardware scrolling moves frame-memory lines, i.e. along the long axis:
+// vertical in portrait, horizontal in landscape. The three areas must add
+// up to LCD_HEIGHT lines.
+void st7796_set_scroll_area(uint16_t top_fixed, uint16_t scroll_lines, uint16_t bottom_fixed) {
+    uint8_t data[6] = {
+        top_fixed >> 8, top_fixed & 0xFF,
+        scroll_lines >> 8, scroll_lines & 0xFF,
+        bottom_fixed >> 8, bottom_fixed & 0xFF,
+    };
+    st7796_write_command(ST7796_VSCRDEF);
+    st7796_write_data_buf(data, 6);
+}
+
+// Frame-memory line shown at the first line of the scroll area
+void st7796_set_scroll_start(uint16_t line) {
+    uint8_t data[2] = { line >> 8, line & 0xFF };
+    st7796_write_command(ST7796_VSCRSADD);
+    st7796_write_data_buf(data, 2);
+}
+
+// Leave scroll mode (normal display mode on); lines show unshifted again
+void st7796_scroll_off(void) {
+    st7796_write_command(ST7796_NORON);
+}
+
 // Draw a character
 void st7796_draw_char(int16_t x, int16_t y, char c, uint16_t color, uint16_t bg_color, uint8_t size) {
     if (c < 32 || c > 90) c = 32; // Space for invalid chars
@@ -346,8 +556,6 @@ void st7796_draw_vbar(int16_t x, int16_t y, int16_t width, int16_t height, uint1
 
 // Test pattern for debugging display
 void st7796_test_pattern(void) {
-    printf("Drawing test pattern...\n");
-    
     // Draw colored rectangles
     st7796_fill_rect(0, 0, _width/3, _height/3, COLOR_RED);
     st7796_fill_rect(_width/3, 0, _width/3, _height/3, COLOR_GREEN);
@@ -360,6 +568,4 @@ void st7796_test_pattern(void) {
     st7796_fill_rect(0, 2*_height/3, _width/3, _height/3, COLOR_WHITE);
     st7796_fill_rect(_width/3, 2*_height/3, _width/3, _height/3, COLOR_GRAY);
     st7796_fill_rect(2*_width/3, 2*_height/3, _width/3, _height/3, COLOR_BLACK);
-    
-    printf("Test pattern complete\n");
 }
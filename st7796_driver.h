@@ -21,15 +21,43 @@
 #define COLOR_DARKGRAY 0x4208
 #define COLOR_ORANGE  0xFD20
 
+// SPI clock: 4 bytes per microsecond on the bus
+#define ST7796_SPI_HZ (32 * 1000 * 1000)
+
+// SPI bytes spent on CASET/RASET/RAMWR before any pixel data is sent
+#define ST7796_WINDOW_SETUP_BYTES 11
+
+// st7796_write_lines() also switches MADCTL there and back
+#define ST7796_LINES_SETUP_BYTES (ST7796_WINDOW_SETUP_BYTES + 4)
+
+// VSCRSADD command and its two parameter bytes
+#define ST7796_SCROLL_START_BYTES 3
+
 // Function prototypes
 void st7796_init(void);
 void st7796_fill_screen(uint16_t color);
 void st7796_draw_pixel(int16_t x, int16_t y, uint16_t color);
 void st7796_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+void st7796_draw_bitmap(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pixels);
+// No bounds checks: for renderers whose rectangles are clipped at compile time
+void st7796_fill_rect_unclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+void st7796_draw_bitmap_unclipped(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pixels);
+// Background blit (clipped block): the next driver call waits for it
+void st7796_draw_bitmap_async(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pixels);
+void st7796_dma_wait(void);
+uint32_t st7796_dma_wait_us(void);
+// Frame-memory lines and hardware scrolling (see st7796_driver.c)
+void st7796_write_lines(uint16_t line, uint16_t count, const uint16_t* pixels);
+void st7796_set_scroll_area(uint16_t top_fixed, uint16_t scroll_lines, uint16_t bottom_fixed);
+void st7796_set_scroll_start(uint16_t line);
+void st7796_scroll_off(void);
 void st7796_draw_char(int16_t x, int16_t y, char c, uint16_t color, uint16_t bg_color, uint8_t size);
 void st7796_draw_string(int16_t x, int16_t y, const char* str, uint16_t color, uint16_t bg_color, uint8_t size);
 void st7796_draw_vbar(int16_t x, int16_t y, int16_t width, int16_t height, uint16_t value, uint16_t max_value, uint16_t color);
 void st7796_set_rotation(uint8_t rotation);
+// Watchdog recovery: readback check and soft resync (see st7796_driver.c)
+bool st7796_verify(void);
+bool st7796_resync(void);
 void st7796_test_pattern(void);  // Test pattern for debugging
 
 #endif // ST7796_DRIVER_H
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/gpio.h"
+#include "stress_pattern.h"
+
+// Stress master for a second Pico: sweeps the packet rate of the I2C receive
+// path with pattern packets, mixing in junk frames, aborted transfers and
+// repeated-START packets. Wire GPIO 20/21 and GND to the device's GPIO 20/21,
+// enable stress mode on the device ('t' over USB serial) and read its STRESS
+// lines; this side prints what it offered for each step.
+#define I2C_PORT i2c0
+#define I2C_SDA 20
+#define I2C_SCL 21
+#define TARGET_ADDR 0x60
+
+#define STEP_MS 3000             // Duration of each rate step
+#define STEP_PAUSE_MS 1000       // Idle gap between steps (separates device reports)
+#define JUNK_EVERY 50            // One junk frame (wrong header) per N packets
+#define ABORT_EVERY 37           // One truncated transfer per N packets
+#define ABORT_LENGTH 20          // Bytes sent before the STOP of a truncated transfer
+#define RESTART_EVERY 10         // One packet per N ends without STOP (repeated START)
+#define WRITE_TIMEOUT_US 5000
+
+// Bus speeds: standard Fast-mode and Fast-mode Plus (needs ~1k pull-ups)
+static const uint32_t bus_speeds[] = {400000, 1000000};
+
+// Offered packet rates (pkt/s). 41 bytes take ~0.95 ms at 400 kHz and
+// ~0.38 ms at 1 MHz, so the top steps saturate the bus.
+static const uint32_t step_rates[] = {60, 120, 250, 400, 600, 800, 1000, 1500, 2000, 2500};
+
+#define NUM_SPEEDS (sizeof(bus_speeds) / sizeof(bus_speeds[0]))
+#define NUM_RATES (sizeof(step_rates) / sizeof(step_rates[0]))
+
+static uint16_t seq = 0;
+static bool bus_held = false;  // Last packet ended without STOP
+
+typedef struct {
+    uint32_t sent;
+    uint32_t junk;
+    uint32_t aborted;
+    uint32_t restarts;
+    uint32_t errors;  // NAK or timeout
+} step_counters_t;
+
+static bool write_frame(const uint8_t* data, size_t len, bool nostop, step_counters_t* c) {
+    bus_held = false;
+    int ret = i2c_write_timeout_us(I2C_PORT, TARGET_ADDR, data, len, nostop, WRITE_TIMEOUT_US);
+    if (ret != (int)len) {
+        c->errors++;
+        return false;
+    }
+    return true;
+}
+
+// Send one scheduled item: a pattern packet, or junk/aborted traffic in its slot
+static void send_next(uint32_t index, step_counters_t* c) {
+    uint8_t packet[STRESS_PACKET_SIZE];
+
+    if (index % JUNK_EVERY == JUNK_EVERY - 1) {
+        stress_pattern_fill(packet, 0xFFFF);
+        packet[0] = STRESS_JUNK_HEADER;
+        if (write_frame(packet, sizeof(packet), false, c)) c->junk++;
+        return;
+    }
+    if (index % ABORT_EVERY == ABORT_EVERY - 1) {
+        stress_pattern_fill(packet, 0xFFFF);
+        if (write_frame(packet, ABORT_LENGTH, false, c)) c->aborted++;
+        return;
+    }
+
+    bool nostop = (index % RESTART_EVERY == RESTART_EVERY - 1);
+    stress_pattern_fill(packet, seq);
+    if (write_frame(packet, sizeof(packet), nostop, c)) {
+        c->sent++;
+        if (nostop) c->restarts++;
+        bus_held = nostop;
+    }
+    seq++;  // Failed writes still consume a number: the device sees them as lost
+}
+
+static void run_step(uint32_t speed, uint32_t rate) {
+    step_counters_t c = {0};
+    uint32_t period_us = 1000000 / rate;
+    uint64_t start = time_us_64();
+    uint64_t next = start;
+    uint32_t index = 0;
+    uint32_t late = 0;
+
+    while (time_us_64() - start < (uint64_t)STEP_MS * 1000) {
+        // Absolute schedule: if the bus cannot keep up, the step runs flat out
+        while (time_us_64() < next) {
+            tight_loop_contents();
+        }
+        if (time_us_64() > next + period_us) late++;
+        send_next(index++, &c);
+        next += period_us;
+    }
+
+    // Release the bus if the last packet ended without STOP (the device
+    // counts this one-byte transfer as aborted)
+    if (bus_held) {
+        uint8_t header = STRESS_JUNK_HEADER;
+        i2c_write_timeout_us(I2C_PORT, TARGET_ADDR, &header, 1, false, WRITE_TIMEOUT_US);
+        bus_held = false;
+    }
+
+    uint32_t elapsed_ms = (uint32_t)((time_us_64() - start) / 1000);
+    printf("STEP speed=%u target=%u achieved=%u pkt/s sent=%u junk=%u abort=%u restart=%u errors=%u late=%u\n",
+           speed, rate, c.sent * 1000 / elapsed_ms, c.sent, c.junk, c.aborted, c.restarts, c.errors, late);
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(3000);  // Wait for USB enumeration
+
+    printf("\n=== I2C Receive Path Stress Master ===\n");
+    printf("Target 0x%02X on SDA=%d, SCL=%d\n", TARGET_ADDR, I2C_SDA, I2C_SCL);
+
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
+
+    while (1) {
+        for (uint32_t s = 0; s < NUM_SPEEDS; s++) {
+            uint32_t actual = i2c_init(I2C_PORT, bus_speeds[s]);
+            printf("\n--- Bus speed %u Hz (actual %u) ---\n", bus_speeds[s], actual);
+
+            for (uint32_t r = 0; r < NUM_RATES; r++) {
+                run_step(bus_speeds[s], step_rates[r]);
+                sleep_ms(STEP_PAUSE_MS);
+            }
+        }
+        printf("\nSweep complete, restarting in 10 s\n");
+        sleep_ms(10000);
+    }
+
+    return 0;
+}
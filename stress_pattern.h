@@ -0,0 +1,42 @@
+#ifndef STRESS_PATTERN_H
+#define STRESS_PATTERN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Test pattern shared by stress_master.c (second Pico) and the device's
+// stress mode. A pattern packet has the normal 41-byte layout:
+//   [0]      0xAA header
+//   [1..2]   sequence number (little-endian)
+//   [3..39]  bytes derived from the sequence number
+//   [40]     checksum: sum of bytes 1..39, low 8 bits
+// so it travels the same receive path as FFT data, and the device can count
+// lost packets from sequence gaps and corrupted ones from the checksum.
+#define STRESS_PACKET_SIZE 41
+#define STRESS_HEADER 0xAA
+#define STRESS_JUNK_HEADER 0x55  // Junk frames: full length, wrong header
+
+static inline void stress_pattern_fill(uint8_t* packet, uint16_t seq) {
+    uint8_t sum = 0;
+    packet[0] = STRESS_HEADER;
+    packet[1] = seq & 0xFF;
+    packet[2] = seq >> 8;
+    for (int i = 3; i < STRESS_PACKET_SIZE - 1; i++) {
+        packet[i] = (uint8_t)(seq * 31 + i * 7);
+    }
+    for (int i = 1; i < STRESS_PACKET_SIZE - 1; i++) {
+        sum += packet[i];
+    }
+    packet[STRESS_PACKET_SIZE - 1] = sum;
+}
+
+static inline bool stress_pattern_check(const uint8_t* packet, uint16_t* seq) {
+    uint8_t sum = 0;
+    for (int i = 1; i < STRESS_PACKET_SIZE - 1; i++) {
+        sum += packet[i];
+    }
+    *seq = packet[1] | (packet[2] << 8);
+    return sum == packet[STRESS_PACKET_SIZE - 1];
+}
+
+#endif // STRESS_PATTERN_H
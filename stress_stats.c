@@ -0,0 +1,165 @@
+#include "stress_stats.h"
+#include "stress_pattern.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include <stdio.h>
+#include <string.h>
+
+volatile bool stress_mode = false;
+
+// Per-interval histograms. IRQ ones are written by the I2C IRQ on Core 0 and
+// swapped out by the report with interrupts masked.
+static stress_hist_t irq_service_us;
+static stress_hist_t irq_fifo_level;
+static stress_hist_t consumer_lag_us;
+
+// Pattern tracking
+static bool seq_synced = false;
+static uint16_t seq_expected = 0;
+static uint32_t interval_valid = 0;
+static uint32_t interval_lost = 0;
+static uint32_t interval_bad_checksum = 0;
+static uint32_t interval_reordered = 0;
+static uint32_t interval_first_us = 0;  // Arrival of the first and last valid packet
+static uint32_t interval_last_us = 0;
+
+// Sweep results
+static uint32_t knee_lossless = 0;  // Highest offered pkt/s without loss
+static uint32_t knee_lossy = 0;     // Lowest offered pkt/s with loss (0 = none yet)
+
+static uint32_t last_report_ms = 0;
+static stress_rx_counters_t last_rx;
+
+static inline void hist_add(stress_hist_t* h, uint32_t value) {
+    int b = (value == 0) ? 0 : 32 - __builtin_clz(value);
+    if (b >= STRESS_HIST_BUCKETS) b = STRESS_HIST_BUCKETS - 1;
+    h->bucket[b]++;
+    h->count++;
+    if (value > h->max) h->max = value;
+}
+
+// Upper bound of the bucket holding the given percentile
+static uint32_t hist_percentile(const stress_hist_t* h, uint32_t percent) {
+    if (h->count == 0) return 0;
+    uint32_t target = (h->count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (int b = 0; b < STRESS_HIST_BUCKETS; b++) {
+        seen += h->bucket[b];
+        if (seen >= target) {
+            uint32_t bound = (b == 0) ? 0 : (1u << b) - 1;
+            return (bound < h->max) ? bound : h->max;
+        }
+    }
+    return h->max;
+}
+
+// Enable or disable stress mode; enabling starts a fresh sweep
+void stress_set_mode(bool enabled) {
+    if (enabled && !stress_mode) {
+        uint32_t irq_state = save_and_disable_interrupts();
+        memset(&irq_service_us, 0, sizeof(irq_service_us));
+        memset(&irq_fifo_level, 0, sizeof(irq_fifo_level));
+        restore_interrupts(irq_state);
+        memset(&consumer_lag_us, 0, sizeof(consumer_lag_us));
+
+        seq_synced = false;
+        interval_valid = interval_lost = interval_bad_checksum = interval_reordered = 0;
+        knee_lossless = knee_lossy = 0;
+        last_report_ms = 0;
+        printf("STRESS mode on\n");
+    } else if (!enabled && stress_mode) {
+        printf("STRESS mode off, knee: lossless up to %u pkt/s, loss from %u pkt/s\n",
+               knee_lossless, knee_lossy);
+    }
+    stress_mode = enabled;
+}
+
+// One I2C interrupt: RX FIFO level on entry and time spent in the handler
+void stress_irq_sample(uint32_t fifo_level, uint32_t service_us) {
+    hist_add(&irq_fifo_level, fifo_level);
+    hist_add(&irq_service_us, service_us);
+}
+
+// One packet with a valid header, lag_us after the IRQ completed it
+void stress_packet(const uint8_t* packet, uint32_t lag_us) {
+    hist_add(&consumer_lag_us, lag_us);
+
+    uint16_t seq;
+    if (!stress_pattern_check(packet, &seq)) {
+        interval_bad_checksum++;
+        return;
+    }
+    uint32_t now_us = time_us_32();
+    if (interval_valid == 0) interval_first_us = now_us;
+    interval_last_us = now_us;
+    interval_valid++;
+
+    if (seq_synced) {
+        uint16_t gap = seq - seq_expected;
+        if (gap < 0x8000) {
+            interval_lost += gap;
+        } else {
+            interval_reordered++;  // Duplicate or older packet
+            return;
+        }
+    }
+    seq_synced = true;
+    seq_expected = seq + 1;
+}
+
+// Print one STRESS line per report interval (main loop)
+void stress_report_poll(uint32_t now_ms, const stress_rx_counters_t* rx) {
+    if (!stress_mode) return;
+    if (last_report_ms == 0) {
+        last_report_ms = now_ms;
+        last_rx = *rx;
+        return;
+    }
+    uint32_t elapsed = now_ms - last_report_ms;
+    if (elapsed < STRESS_REPORT_MS) return;
+
+    // Take this interval's IRQ histograms
+    stress_hist_t service, fifo;
+    uint32_t irq_state = save_and_disable_interrupts();
+    service = irq_service_us;
+    fifo = irq_fifo_level;
+    memset(&irq_service_us, 0, sizeof(irq_service_us));
+    memset(&irq_fifo_level, 0, sizeof(irq_fifo_level));
+    restore_interrupts(irq_state);
+
+    uint32_t offered = (interval_valid + interval_lost) * 1000 / elapsed;
+    uint32_t received = interval_valid * 1000 / elapsed;
+
+    // The knee uses the rate while packets were arriving: an interval that
+    // spans the end of a master step would otherwise file its loss under a
+    // rate diluted by the idle pause
+    uint32_t span_us = interval_last_us - interval_first_us;
+    uint32_t active = offered;
+    if (interval_valid > 1 && span_us > 0) {
+        active = (uint32_t)((uint64_t)(interval_valid + interval_lost - 1) * 1000000 / span_us);
+    }
+    if (interval_valid > 0) {
+        if (interval_lost == 0 && interval_bad_checksum == 0) {
+            if (active > knee_lossless) knee_lossless = active;
+        } else if (knee_lossy == 0 || active < knee_lossy) {
+            knee_lossy = active;
+        }
+    }
+
+    printf("STRESS offered=%u rx=%u pkt/s lost=%u bad=%u reord=%u junk=%u abort=%u fifo_over=%u drop_bytes=%u\n",
+           offered, received, interval_lost, interval_bad_checksum, interval_reordered,
+           rx->invalid_headers - last_rx.invalid_headers,
+           rx->aborted - last_rx.aborted,
+           rx->fifo_overflows - last_rx.fifo_overflows,
+           rx->dropped_bytes - last_rx.dropped_bytes);
+    printf("STRESS irq_us p50=%u p99=%u max=%u fifo p50=%u p99=%u max=%u lag_us p50=%u p99=%u max=%u knee=%u/%u\n",
+           hist_percentile(&service, 50), hist_percentile(&service, 99), service.max,
+           hist_percentile(&fifo, 50), hist_percentile(&fifo, 99), fifo.max,
+           hist_percentile(&consumer_lag_us, 50), hist_percentile(&consumer_lag_us, 99), consumer_lag_us.max,
+           knee_lossless, knee_lossy);
+
+    memset(&consumer_lag_us, 0, sizeof(consumer_lag_us));
+    interval_valid = interval_lost = interval_bad_checksum = interval_reordered = 0;
+    last_report_ms = now_ms;
+    last_rx = *rx;
+}
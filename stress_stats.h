@@ -0,0 +1,38 @@
+#ifndef STRESS_STATS_H
+#define STRESS_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Receive-path stress measurements, active while stress mode is on. The
+// master (stress_master.c on a second Pico) sweeps the packet rate with
+// pattern packets (stress_pattern.h); the device prints one STRESS line per
+// report interval with loss, IRQ cost and consumer lag, and tracks the knee:
+// the highest offered rate without loss and the lowest rate with loss.
+#define STRESS_REPORT_MS 1000
+#define STRESS_HIST_BUCKETS 16  // Power-of-two buckets: 0, 1, 2-3, 4-7, ...
+
+typedef struct {
+    uint32_t bucket[STRESS_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+} stress_hist_t;
+
+// Receive counters owned by the I2C path, passed in for each report
+typedef struct {
+    uint32_t packets;          // Packets with a valid header
+    uint32_t invalid_headers;  // Junk frames
+    uint32_t aborted;          // Transfers stopped before a full packet
+    uint32_t fifo_overflows;   // RX FIFO overruns (IRQ too late)
+    uint32_t dropped_bytes;    // Bytes arriving while the last packet was unconsumed
+} stress_rx_counters_t;
+
+extern volatile bool stress_mode;
+
+// Function prototypes
+void stress_set_mode(bool enabled);
+void stress_irq_sample(uint32_t fifo_level, uint32_t service_us);
+void stress_packet(const uint8_t* packet, uint32_t lag_us);
+void stress_report_poll(uint32_t now_ms, const stress_rx_counters_t* rx);
+
+#endif // STRESS_STATS_H
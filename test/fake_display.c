@@ -0,0 +1,193 @@
+// Framebuffer stand-in for st7796_driver.c (see fake_display.h)
+#include "st7796_driver.h"
+#include "fake_display.h"
+#include "pico/stdlib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+uint16_t fb[SCREEN_H][SCREEN_W];
+uint8_t fb_written[SCREEN_H][SCREEN_W];
+bool fb_null = false;
+uint64_t fb_pixels_written = 0;
+uint32_t fb_fill_calls = 0;
+uint64_t fb_fill_pixels = 0;
+uint32_t fb_blit_calls = 0;
+uint32_t fb_min_fill_pixels = UINT32_MAX;
+uint32_t fb_text_bad_chars = 0;
+fb_text_t fb_text[FB_TEXT_MAX];
+int fb_text_count = 0;
+
+// Frame-memory scroll state (landscape: a line is a screen column)
+static bool scroll_on = false;
+static int scroll_top = 0;
+static int scroll_lines = SCREEN_W;
+static int scroll_start = 0;
+
+// The panel's pins are only modelled by sim_panel.c
+void gpio_put(uint pin, bool value) { (void)pin; (void)value; }
+
+void fb_clear(uint16_t color) {
+    for (int y = 0; y < SCREEN_H; y++) {
+        for (int x = 0; x < SCREEN_W; x++) {
+            fb[y][x] = color;
+        }
+    }
+}
+
+void fb_written_clear(void) {
+    memset(fb_written, 0, sizeof(fb_written));
+}
+
+void fb_text_clear(void) {
+    fb_text_count = 0;
+}
+
+static void check_unclipped(const char* call, int x, int y, int w, int h) {
+    if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > SCREEN_W || y + h > SCREEN_H) {
+        printf("FAIL: %s(%d, %d, %d, %d) outside the screen\n", call, x, y, w, h);
+        exit(2);
+    }
+}
+
+static void put_rect(int x, int y, int w, int h, const uint16_t* pixels, int stride, uint16_t color) {
+    fb_pixels_written += (uint64_t)w * h;
+    if (fb_null) return;
+    for (int j = 0; j < h; j++) {
+        for (int i = 0; i < w; i++) {
+            fb[y + j][x + i] = pixels ? pixels[j * stride + i] : color;
+            fb_written[y + j][x + i] = 1;
+        }
+    }
+}
+
+// Clip like the driver: rectangles starting off screen are dropped
+static bool clip(int x, int y, int* w, int* h) {
+    if (x < 0 || y < 0 || x >= SCREEN_W || y >= SCREEN_H || *w <= 0 || *h <= 0) return false;
+    if (x + *w > SCREEN_W) *w = SCREEN_W - x;
+    if (y + *h > SCREEN_H) *h = SCREEN_H - y;
+    return true;
+}
+
+void st7796_init(void) {}
+void st7796_set_rotation(uint8_t rotation) { (void)rotation; }
+void st7796_test_pattern(void) {}
+bool st7796_verify(void) { return true; }
+bool st7796_resync(void) { return true; }
+void st7796_dma_wait(void) {}
+uint32_t st7796_dma_wait_us(void) { return 0; }
+
+void st7796_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    int cw = w, ch = h;
+    if (!clip(x, y, &cw, &ch)) return;
+    fb_fill_calls++;
+    fb_fill_pixels += (uint64_t)cw * ch;
+    put_rect(x, y, cw, ch, NULL, 0, color);
+}
+
+void st7796_fill_rect_unclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    check_unclipped("st7796_fill_rect_unclipped", x, y, w, h);
+    fb_fill_calls++;
+    fb_fill_pixels += (uint64_t)w * h;
+    if (w > 1 && (uint32_t)(w * h) < fb_min_fill_pixels) fb_min_fill_pixels = w * h;
+    put_rect(x, y, w, h, NULL, 0, color);
+}
+
+void st7796_fill_screen(uint16_t color) {
+    st7796_fill_rect(0, 0, SCREEN_W, SCREEN_H, color);
+}
+
+void st7796_draw_pixel(int16_t x, int16_t y, uint16_t color) {
+    st7796_fill_rect(x, y, 1, 1, color);
+}
+
+void st7796_draw_bitmap(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pixels) {
+    int cw = w, ch = h;
+    if (!clip(x, y, &cw, &ch)) return;
+    fb_blit_calls++;
+    put_rect(x, y, cw, ch, pixels, w, 0);
+}
+
+void st7796_draw_bitmap_unclipped(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pixels) {
+    check_unclipped("st7796_draw_bitmap_unclipped", x, y, w, h);
+    fb_blit_calls++;
+    put_rect(x, y, w, h, pixels, w, 0);
+}
+
+void st7796_draw_bitmap_async(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t* pixels) {
+    st7796_draw_bitmap(x, y, w, h, pixels);
+}
+
+// Text is recorded, not rasterized: tests check placement and the font range
+void st7796_draw_char(int16_t x, int16_t y, char c, uint16_t color, uint16_t bg_color, uint8_t size) {
+    char s[2] = {c, 0};
+    st7796_draw_string(x, y, s, color, bg_color, size);
+}
+
+void st7796_draw_string(int16_t x, int16_t y, const char* str, uint16_t color, uint16_t bg_color, uint8_t size) {
+    (void)color; (void)bg_color;
+    int len = (int)strlen(str);
+    for (int i = 0; i < len; i++) {
+        if (str[i] < 32 || str[i] > 90) fb_text_bad_chars++;
+    }
+    if (fb_text_count < FB_TEXT_MAX) {
+        fb_text_t* t = &fb_text[fb_text_count++];
+        t->x = x;
+        t->y = y;
+        t->w = len * 6 * size;
+        t->h = 8 * size;
+        snprintf(t->text, sizeof(t->text), "%s", str);
+    }
+}
+
+void st7796_draw_vbar(int16_t x, int16_t y, int16_t width, int16_t height, uint16_t value, uint16_t max_value, uint16_t color) {
+    (void)value; (void)max_value; (void)color;
+    st7796_fill_rect(x, y, width, height, COLOR_BLACK);
+}
+
+// Landscape frame memory: line l is screen column l, pixel 0 at the bottom
+void st7796_write_lines(uint16_t line, uint16_t count, const uint16_t* pixels) {
+    if (line + count > LCD_HEIGHT || SCREEN_H != LCD_WIDTH) {
+        printf("FAIL: st7796_write_lines(%u, %u) outside frame memory\n", line, count);
+        exit(2);
+    }
+    fb_blit_calls++;
+    fb_pixels_written += (uint64_t)count * LCD_WIDTH;
+    if (fb_null) return;
+    for (int k = 0; k < count; k++) {
+        for (int i = 0; i < LCD_WIDTH; i++) {
+            fb[SCREEN_H - 1 - i][line + k] = pixels[k * LCD_WIDTH + i];
+        }
+    }
+}
+
+void st7796_set_scroll_area(uint16_t top_fixed, uint16_t lines, uint16_t bottom_fixed) {
+    if (top_fixed + lines + bottom_fixed != LCD_HEIGHT) {
+        printf("FAIL: scroll area %u + %u + %u\n", top_fixed, lines, bottom_fixed);
+        exit(2);
+    }
+    scroll_top = top_fixed;
+    scroll_lines = lines;
+    scroll_on = true;
+}
+
+void st7796_set_scroll_start(uint16_t line) {
+    scroll_start = line;
+    scroll_on = true;
+}
+
+void st7796_scroll_off(void) {
+    scroll_on = false;
+}
+
+void fb_display(uint16_t (*out)[SCREEN_W]) {
+    for (int y = 0; y < SCREEN_H; y++) {
+        for (int x = 0; x < SCREEN_W; x++) {
+            int m = x;
+            if (scroll_on && x >= scroll_top && x < scroll_top + scroll_lines) {
+                m = scroll_top + (scroll_start - scroll_top + x - scroll_top) % scroll_lines;
+            }
+            out[y][x] = fb[y][m];
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef FAKE_DISPLAY_H
+#define FAKE_DISPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "spectro_geometry.h"
+
+// ST7796 driver API drawing into a framebuffer in screen coordinates of the
+// geometry profile, without bus timing (fake_display.c). Unclipped calls
+// outside the screen abort the test. Frame-memory lines and the hardware
+// scroll are modelled for the landscape profiles.
+extern uint16_t fb[SCREEN_H][SCREEN_W];
+extern uint8_t fb_written[SCREEN_H][SCREEN_W];  // Set on every pixel write
+extern bool fb_null;                            // Drop pixel stores (benchmarks)
+extern uint64_t fb_pixels_written;
+extern uint32_t fb_fill_calls;
+extern uint64_t fb_fill_pixels;   // Pixels sent by fills (no source buffer)
+extern uint32_t fb_blit_calls;
+extern uint32_t fb_min_fill_pixels;  // Smallest unclipped fill wider than a divider
+extern uint32_t fb_text_bad_chars;  // Characters the 5x7 font does not cover
+
+// Text drawn since the last fb_text_clear(), as rectangles (6x8 px per
+// character at size 1)
+#define FB_TEXT_MAX 64
+typedef struct {
+    int16_t x, y, w, h;
+    char text[40];
+} fb_text_t;
+extern fb_text_t fb_text[FB_TEXT_MAX];
+extern int fb_text_count;
+
+void fb_clear(uint16_t color);
+void fb_written_clear(void);
+void fb_text_clear(void);
+void fb_display(uint16_t (*out)[SCREEN_W]);  // What the panel shows (scroll applied)
+
+#endif // FAKE_DISPLAY_H
@@ -0,0 +1,54 @@
+// Microsecond clock for the host tests (see sim_sdk.h)
+#include "pico/stdlib.h"
+#include "sim_sdk.h"
+#include <time.h>
+
+uint64_t fake_us = 0;
+static double clock_scale = 0.0;
+static double host_base_ns = -1.0;
+static double host_excluded_ns = 0.0;
+static double exclude_start_ns = 0.0;
+
+double sim_host_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+void sim_clock_set_scale(double scale) {
+    fake_us = sim_clock_now();
+    clock_scale = scale;
+    host_base_ns = sim_host_ns();
+    host_excluded_ns = 0.0;
+}
+
+uint64_t sim_clock_now(void) {
+    if (clock_scale == 0.0) return fake_us;
+    double host_ns = sim_host_ns() - host_base_ns - host_excluded_ns;
+    return fake_us + (uint64_t)(host_ns * clock_scale / 1000.0);
+}
+
+void sim_clock_advance(uint64_t us) {
+    fake_us += us;
+}
+
+void sim_clock_advance_to(uint64_t us) {
+    uint64_t now = sim_clock_now();
+    if (us > now) fake_us += us - now;
+}
+
+void sim_clock_exclude_begin(void) {
+    exclude_start_ns = sim_host_ns();
+}
+
+void sim_clock_exclude_end(void) {
+    host_excluded_ns += sim_host_ns() - exclude_start_ns;
+}
+
+absolute_time_t get_absolute_time(void) { return sim_clock_now(); }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+uint32_t time_us_32(void) { return (uint32_t)sim_clock_now(); }
+uint64_t time_us_64(void) { return sim_clock_now(); }
+void sleep_ms(uint32_t ms) { fake_us += ms * 1000ull; }
+void sleep_us(uint64_t us) { fake_us += us; }
+void busy_wait_us_32(uint32_t us) { fake_us += us; }
@@ -0,0 +1,48 @@
+// RAM flash region for the history tests (see sim_flash.h)
+#include "sim_flash.h"
+#include "sim_sdk.h"
+#include <string.h>
+
+uint8_t sim_flash[FLASH_HISTORY_SIZE];
+uint64_t sim_flash_erased_bytes = 0;
+uint64_t sim_flash_programmed_bytes = 0;
+uint32_t sim_flash_erases[FLASH_HISTORY_SECTORS];
+uint32_t sim_flash_bad_bits = 0;
+int sim_flash_programs_left = -1;
+
+void sim_flash_reset(void) {
+    memset(sim_flash, 0xFF, sizeof(sim_flash));
+    memset(sim_flash_erases, 0, sizeof(sim_flash_erases));
+    sim_flash_erased_bytes = 0;
+    sim_flash_programmed_bytes = 0;
+    sim_flash_bad_bits = 0;
+    sim_flash_programs_left = -1;
+}
+
+static void sim_erase_sector(uint32_t offset) {
+    memset(&sim_flash[offset], 0xFF, FLASH_HISTORY_SECTOR_SIZE);
+    sim_flash_erases[offset / FLASH_HISTORY_SECTOR_SIZE]++;
+    sim_flash_erased_bytes += FLASH_HISTORY_SECTOR_SIZE;
+    sim_clock_advance(SIM_FLASH_ERASE_US);
+}
+
+static void sim_program(uint32_t offset, const uint8_t* data, uint32_t len) {
+    if (sim_flash_programs_left == 0) return;
+    if (sim_flash_programs_left > 0) sim_flash_programs_left--;
+    for (uint32_t i = 0; i < len; i++) {
+        sim_flash_bad_bits += __builtin_popcount(data[i] & ~sim_flash[offset + i]);
+        sim_flash[offset + i] &= data[i];
+    }
+    sim_flash_programmed_bytes += len;
+    sim_clock_advance((len + 255) / 256 * SIM_FLASH_PAGE_US);
+}
+
+static const uint8_t* sim_map(uint32_t offset) {
+    return &sim_flash[offset];
+}
+
+const flash_history_backend_t sim_flash_backend = {
+    .erase_sector = sim_erase_sector,
+    .program = sim_program,
+    .map = sim_map,
+};
@@ -0,0 +1,30 @@
+#ifndef SIM_FLASH_H
+#define SIM_FLASH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "flash_history.h"
+
+// RAM flash region for flash_history.c with NOR rules: erase sets a sector
+// to 0xFF, programming can only clear bits. Erase and program advance the
+// clock by typical QSPI flash times (W25Q16: 45 ms per 4 KB sector erase,
+// 0.4 ms per 256-byte page).
+#define SIM_FLASH_ERASE_US 45000
+#define SIM_FLASH_PAGE_US 400
+
+extern uint8_t sim_flash[FLASH_HISTORY_SIZE];
+extern const flash_history_backend_t sim_flash_backend;
+
+// Counters since sim_flash_reset()
+extern uint64_t sim_flash_erased_bytes;
+extern uint64_t sim_flash_programmed_bytes;
+extern uint32_t sim_flash_erases[FLASH_HISTORY_SECTORS];
+extern uint32_t sim_flash_bad_bits;  // Programmed bits that needed 0 -> 1
+
+// Power cut: after this many more program calls, programs are dropped
+// (-1 = off)
+extern int sim_flash_programs_left;
+
+void sim_flash_reset(void);
+
+#endif // SIM_FLASH_H
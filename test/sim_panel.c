@@ -0,0 +1,271 @@
+// SPI, DMA and ST7796 panel model under the real driver (see sim_panel.h)
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "sim_sdk.h"
+#include "sim_panel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Driver pins (st7796_driver.c)
+#define PIN_CS 5
+#define PIN_DC 6
+#define PIN_RST 7
+
+// Panel commands the model decodes
+#define CMD_RDDMADCTL 0x0B
+#define CMD_RDDCOLMOD 0x0C
+#define CMD_NORON 0x13
+#define CMD_CASET 0x2A
+#define CMD_RASET 0x2B
+#define CMD_RAMWR 0x2C
+#define CMD_VSCRDEF 0x33
+#define CMD_MADCTL 0x36
+#define CMD_VSCRSADD 0x37
+#define CMD_COLMOD 0x3A
+#define COLMOD_RESET 0x66  // 18-bit color until the driver sets 16-bit
+
+uint16_t sim_panel_fb[SIM_PANEL_SIZE][SIM_PANEL_SIZE];
+bool sim_panel_pixels = true;
+uint64_t sim_panel_bus_us = 0;
+uint64_t sim_panel_dma_bytes = 0;
+uint32_t sim_panel_dma_bursts = 0;
+uint64_t sim_panel_dma_stall_us = 0;
+int sim_panel_fault = SIM_PANEL_OK;
+uint32_t sim_panel_resets = 0;
+
+// Controller state
+static bool data_mode = true;  // D/C high
+static uint8_t command;
+static int args;
+static uint8_t arg[6];
+static int window_x0, window_x1, window_y0, window_y1;
+static int cursor_x, cursor_y;
+static uint8_t madctl, colmod = COLMOD_RESET;
+static bool scroll_on = false;  // Vertical scrolling mode (after VSCRSADD)
+static int scroll_top, scroll_lines = SIM_PANEL_SIZE, scroll_start;
+static uint64_t bus_free_us = 0;  // End of the transfer on the bus
+
+// DMA channel (one, as the driver claims)
+static const uint16_t* dma_src;
+static uint32_t dma_count;
+static bool dma_increment;
+static bool dma_busy = false;
+static uint64_t dma_end_us;
+
+struct spi_inst {
+    int unused;
+};
+spi_inst_t spi0_inst, spi1_inst;
+static spi_hw_t spi_regs;
+
+static uint64_t bus_time_us(uint64_t bytes, uint32_t hz) {
+    return (bytes * 8 * 1000000 + hz - 1) / hz;
+}
+
+// A low pulse on RST restores the power-on registers and leaves the frame
+// memory undefined; it also clears a wedged panel
+void gpio_put(uint pin, bool value) {
+    if (pin == PIN_DC) data_mode = value;
+    if (pin != PIN_RST || value) return;
+    sim_panel_resets++;
+    if (sim_panel_fault == SIM_PANEL_WEDGED) sim_panel_fault = SIM_PANEL_OK;
+    if (sim_panel_fault != SIM_PANEL_OK) return;
+    madctl = 0;
+    colmod = COLMOD_RESET;
+    scroll_on = false;
+    for (int y = 0; y < SIM_PANEL_SIZE; y++) {
+        for (int x = 0; x < SIM_PANEL_SIZE; x++) {
+            sim_panel_fb[y][x] = SIM_PANEL_RESET_COLOR;
+        }
+    }
+}
+
+static void put_pixel(uint16_t color) {
+    if (sim_panel_fault != SIM_PANEL_OK) return;
+    if (sim_panel_pixels && cursor_x < SIM_PANEL_SIZE && cursor_y < SIM_PANEL_SIZE) {
+        sim_panel_fb[cursor_y][cursor_x] = color;
+    }
+    if (++cursor_x > window_x1) {
+        cursor_x = window_x0;
+        cursor_y++;
+    }
+}
+
+uint spi_init(spi_inst_t* spi, uint baudrate) { (void)spi; return baudrate; }
+void spi_deinit(spi_inst_t* spi) { (void)spi; }
+uint spi_set_baudrate(spi_inst_t* spi, uint baudrate) { (void)spi; return baudrate; }
+spi_hw_t* spi_get_hw(spi_inst_t* spi) { (void)spi; return &spi_regs; }
+uint spi_get_dreq(spi_inst_t* spi, bool is_tx) { (void)spi; (void)is_tx; return 0; }
+bool spi_is_busy(spi_inst_t* spi) { (void)spi; return false; }
+bool spi_is_readable(spi_inst_t* spi) { (void)spi; return false; }
+
+void spi_set_format(spi_inst_t* spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order) {
+    (void)spi;
+    (void)data_bits;
+    (void)cpol;
+    (void)cpha;
+    (void)order;
+}
+
+// Commands and parameters (8-bit writes); the window is decoded for RAMWR
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len) {
+    (void)spi;
+    sim_clock_advance_to(bus_free_us);
+    uint64_t bus_us = bus_time_us(len, SIM_PANEL_SPI_HZ);
+    sim_clock_advance(bus_us);
+    sim_panel_bus_us += bus_us;
+    if (sim_panel_fault != SIM_PANEL_OK) return len;
+
+    for (size_t i = 0; i < len; i++) {
+        if (!data_mode) {
+            command = src[i];
+            args = 0;
+            if (command == CMD_RAMWR) {
+                cursor_x = window_x0;
+                cursor_y = window_y0;
+            } else if (command == CMD_NORON) {
+                scroll_on = false;
+            }
+            continue;
+        }
+        if (args < 6) arg[args] = src[i];
+        args++;
+        if (command == CMD_CASET && args == 4) {
+            window_x0 = arg[0] << 8 | arg[1];
+            window_x1 = arg[2] << 8 | arg[3];
+        } else if (command == CMD_RASET && args == 4) {
+            window_y0 = arg[0] << 8 | arg[1];
+            window_y1 = arg[2] << 8 | arg[3];
+        } else if (command == CMD_VSCRDEF && args == 6) {
+            scroll_top = arg[0] << 8 | arg[1];
+            scroll_lines = arg[2] << 8 | arg[3];
+        } else if (command == CMD_VSCRSADD && args == 2) {
+            scroll_start = arg[0] << 8 | arg[1];
+            scroll_on = true;
+        } else if (command == CMD_MADCTL) {
+            madctl = src[i];
+        } else if (command == CMD_COLMOD) {
+            colmod = src[i];
+        }
+    }
+    return len;
+}
+
+// Register readback: a dummy byte, then the value. A dead panel reads 0xFF.
+int spi_read_blocking(spi_inst_t* spi, uint8_t repeated_tx_data, uint8_t* dst, size_t len) {
+    (void)spi;
+    (void)repeated_tx_data;
+    sim_clock_advance(bus_time_us(len, SIM_PANEL_READ_HZ));
+    memset(dst, (sim_panel_fault == SIM_PANEL_DEAD) ? 0xFF : 0x00, len);
+    if (sim_panel_fault == SIM_PANEL_OK && len >= 2) {
+        if (command == CMD_RDDMADCTL) dst[1] = madctl;
+        if (command == CMD_RDDCOLMOD) dst[1] = colmod;
+    }
+    return len;
+}
+
+int dma_claim_unused_channel(bool required) { (void)required; return 0; }
+void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size) {
+    (void)c;
+    (void)size;
+}
+void channel_config_set_write_increment(dma_channel_config* c, bool incr) { (void)c; (void)incr; }
+void channel_config_set_dreq(dma_channel_config* c, uint dreq) { (void)c; (void)dreq; }
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    (void)channel;
+    dma_channel_config c = {0};
+    return c;
+}
+
+void channel_config_set_read_increment(dma_channel_config* c, bool incr) {
+    c->ctrl = incr ? (c->ctrl | 1) : (c->ctrl & ~1u);
+}
+
+// A burst starts when the bus is free and holds it for 16 bits per transfer
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger) {
+    (void)channel;
+    (void)write_addr;
+    (void)trigger;
+    if (dma_busy) {
+        printf("FAIL: DMA channel restarted while busy\n");
+        exit(3);
+    }
+    dma_src = (const uint16_t*)read_addr;
+    dma_count = transfer_count;
+    dma_increment = config->ctrl & 1;
+    dma_busy = true;
+    uint64_t start_us = sim_clock_now();
+    if (start_us < bus_free_us) start_us = bus_free_us;
+    uint64_t bus_us = (uint64_t)transfer_count * 16 * 1000000 / SIM_PANEL_SPI_HZ;
+    dma_end_us = bus_free_us = start_us + bus_us;
+    sim_panel_bus_us += bus_us;
+    sim_panel_dma_bytes += transfer_count * 2;
+    sim_panel_dma_bursts++;
+}
+
+// The source is read at completion, not at the start
+static void dma_complete(void) {
+    sim_clock_exclude_begin();
+    for (uint32_t i = 0; i < dma_count; i++) {
+        put_pixel(dma_increment ? dma_src[i] : dma_src[0]);
+    }
+    sim_clock_exclude_end();
+    dma_busy = false;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+    (void)channel;
+    if (!dma_busy) return;
+    uint64_t now = sim_clock_now();
+    if (dma_end_us > now) {
+        sim_panel_dma_stall_us += dma_end_us - now;
+        sim_clock_advance(dma_end_us - now);
+    }
+    dma_complete();
+}
+
+bool dma_channel_is_busy(uint channel) {
+    (void)channel;
+    if (dma_busy && sim_clock_now() >= dma_end_us) dma_complete();
+    return dma_busy;
+}
+
+void dma_channel_abort(uint channel) {
+    (void)channel;
+    dma_busy = false;
+    bus_free_us = sim_clock_now();
+}
+
+// Scrolling shifts frame-memory lines, which are page addresses (rows of
+// sim_panel_fb) under the MADCTL st7796_write_lines() uses
+void sim_panel_display(uint16_t (*out)[SIM_PANEL_SIZE]) {
+    for (int y = 0; y < SIM_PANEL_SIZE; y++) {
+        int m = y;
+        if (scroll_on && y >= scroll_top && y < scroll_top + scroll_lines) {
+            m = scroll_top + (scroll_start - scroll_top + y - scroll_top) % scroll_lines;
+        }
+        memcpy(out[y], sim_panel_fb[m], sizeof(out[y]));
+    }
+}
+
+// Registers back at their power-on values without a reset pulse (a supply
+// glitch); frame memory is kept
+void sim_panel_glitch(void) {
+    madctl = 0;
+    colmod = COLMOD_RESET;
+    scroll_on = false;
+}
+
+void sim_panel_hang_dma(void) {
+    static const uint16_t zero = 0;
+    dma_src = &zero;
+    dma_count = 1;
+    dma_increment = false;
+    dma_busy = true;
+    dma_end_us = bus_free_us = UINT64_MAX >> 2;
+}
@@ -0,0 +1,42 @@
+#ifndef SIM_PANEL_H
+#define SIM_PANEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Timed ST7796 panel under the real st7796_driver.c (sim_panel.c), in place
+// of fake_display.c. The SPI bus runs at SIM_PANEL_SPI_HZ: a blocking write
+// waits for the bus and advances the clock by its transfer time, a DMA burst
+// occupies the bus from its start and reads its source only when it
+// completes, so a buffer reused while its burst is in flight shows up as
+// wrong pixels on the panel. CPU time between bus operations comes from the
+// clock scale (sim_clock_set_scale).
+#define SIM_PANEL_SPI_HZ 32000000
+#define SIM_PANEL_READ_HZ 6000000  // Register reads run at a lower clock
+#define SIM_PANEL_SIZE 480
+#define SIM_PANEL_RESET_COLOR 0x1234  // Frame memory after a reset pulse
+
+// Frame memory by column/page address (screen coordinates once the driver
+// has set the rotation)
+extern uint16_t sim_panel_fb[SIM_PANEL_SIZE][SIM_PANEL_SIZE];
+extern bool sim_panel_pixels;  // Store pixels; off for timing-only runs
+void sim_panel_display(uint16_t (*out)[SIM_PANEL_SIZE]);  // What it shows (scroll applied)
+
+// Bus counters
+extern uint64_t sim_panel_bus_us;        // Time the bus was sending
+extern uint64_t sim_panel_dma_bytes;
+extern uint32_t sim_panel_dma_bursts;
+extern uint64_t sim_panel_dma_stall_us;  // CPU time spent waiting for bursts
+
+// Faults. A wedged panel ignores the bus until a reset pulse; a dead one
+// ignores it for good and reads back 0xFF.
+#define SIM_PANEL_OK 0
+#define SIM_PANEL_WEDGED 1
+#define SIM_PANEL_DEAD 2
+extern int sim_panel_fault;
+extern uint32_t sim_panel_resets;
+
+void sim_panel_hang_dma(void);  // Start a burst that never completes
+void sim_panel_glitch(void);    // Lose MADCTL/COLMOD, keep the frame memory
+
+#endif // SIM_PANEL_H
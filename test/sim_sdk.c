@@ -0,0 +1,201 @@
+// Host stand-ins for the Pico SDK calls that need no timing model: stdio,
+// pins, interrupts, cores, locks and the I2C slave registers. Time comes
+// from sim_clock.c or sim_panel.c.
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "pico/mutex.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/resets.h"
+#include "hardware/clocks.h"
+#include "hardware/flash.h"
+#include "sim_sdk.h"
+#include <stdio.h>
+
+// USB serial: input scripted by the test, output captured
+uint8_t sim_in[SIM_IN_SIZE];
+int sim_in_len = 0;
+int sim_in_pos = 0;
+uint8_t sim_out[SIM_OUT_SIZE];
+int sim_out_len = 0;
+bool sim_echo = false;  // Also print captured output
+
+void stdio_init_all(void) {}
+void stdio_flush(void) {}
+void tight_loop_contents(void) {}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    (void)timeout_us;
+    if (sim_in_pos < sim_in_len) return sim_in[sim_in_pos++];
+    return PICO_ERROR_TIMEOUT;
+}
+
+int putchar_raw(int c) {
+    if (sim_out_len < SIM_OUT_SIZE) sim_out[sim_out_len++] = (uint8_t)c;
+    if (sim_echo) putchar(c);
+    return c;
+}
+
+void sim_input(const void* data, int len) {
+    const uint8_t* bytes = data;
+    if (sim_in_pos == sim_in_len) {
+        sim_in_pos = sim_in_len = 0;  // Everything read: reuse the buffer
+    }
+    for (int i = 0; i < len && sim_in_len < SIM_IN_SIZE; i++) {
+        sim_in[sim_in_len++] = bytes[i];
+    }
+}
+
+void sim_output_clear(void) {
+    sim_out_len = 0;
+}
+
+// Pins: inputs read high (buttons released, touch INT idle)
+void gpio_init(uint pin) { (void)pin; }
+void gpio_set_dir(uint pin, bool out) { (void)pin; (void)out; }
+bool gpio_get(uint pin) { (void)pin; return true; }
+void gpio_pull_up(uint pin) { (void)pin; }
+void gpio_disable_pulls(uint pin) { (void)pin; }
+void gpio_set_function(uint pin, enum gpio_function fn) { (void)pin; (void)fn; }
+void gpio_set_irq_enabled_with_callback(uint pin, uint32_t events, bool enabled, gpio_irq_callback_t callback) {
+    (void)pin; (void)events; (void)enabled; (void)callback;
+}
+void gpio_set_irq_enabled(uint pin, uint32_t events, bool enabled) { (void)pin; (void)events; (void)enabled; }
+
+// Single-threaded host: one core, interrupts are called by the test
+uint get_core_num(void) { return 0; }
+uint32_t save_and_disable_interrupts(void) { return 0; }
+void restore_interrupts(uint32_t status) { (void)status; }
+void __dmb(void) {}
+void __wfe(void) {}
+void __sev(void) {}
+void irq_set_enabled(uint num, bool enabled) { (void)num; (void)enabled; }
+void irq_set_exclusive_handler(uint num, void (*handler)(void)) { (void)num; (void)handler; }
+void irq_set_priority(uint num, uint8_t priority) { (void)num; (void)priority; }
+void reset_block(uint32_t bits) { (void)bits; }
+void unreset_block(uint32_t bits) { (void)bits; }
+void unreset_block_wait(uint32_t bits) { (void)bits; }
+void multicore_reset_core1(void) {}
+void multicore_launch_core1(void (*entry)(void)) { (void)entry; }
+
+void mutex_init(mutex_t* mtx) { mtx->owner = 0; }
+bool mutex_try_enter(mutex_t* mtx, uint32_t* owner_out) {
+    (void)owner_out;
+    if (mtx->owner) return false;
+    mtx->owner = 1;
+    return true;
+}
+void mutex_enter_blocking(mutex_t* mtx) { mtx->owner = 1; }
+void mutex_exit(mutex_t* mtx) { mtx->owner = 0; }
+
+uint32_t clock_get_hz(enum clock_index clk) {
+    (void)clk;
+    return SIM_CLK_SYS_HZ;
+}
+
+void flash_range_erase(uint32_t offset, size_t count) { (void)offset; (void)count; }
+void flash_range_program(uint32_t offset, const uint8_t* data, size_t count) {
+    (void)offset; (void)data; (void)count;
+}
+
+// I2C slave: a register block and RX FIFO the test fills (see sim_i2c_*)
+struct i2c_inst {
+    int index;
+};
+i2c_inst_t i2c0_inst = {0}, i2c1_inst = {1};
+static i2c_hw_t i2c_hw[2];
+static uint8_t i2c_fifo[SIM_I2C_FIFO_DEPTH];
+static int i2c_fifo_head = 0;
+static int i2c_fifo_count = 0;
+static bool i2c_in_irq = false;
+static int i2c_level_checks = 0;
+static int i2c_irq_bytes = 0;
+static uint32_t i2c_base_ns = 0;
+static uint32_t i2c_byte_ns = 0;
+static uint64_t i2c_irq_start_us = 0;
+
+// Handler cost while sim_i2c_irq() runs (manual clock): base_ns once
+// the entry level check is done, byte_ns per byte read
+static void i2c_irq_charge(void) {
+    uint64_t ns = i2c_base_ns + (uint64_t)i2c_irq_bytes * i2c_byte_ns;
+    fake_us = i2c_irq_start_us + ns / 1000;
+}
+
+i2c_hw_t* i2c_get_hw(i2c_inst_t* i2c) {
+    return &i2c_hw[i2c->index];
+}
+
+size_t i2c_get_read_available(i2c_inst_t* i2c) {
+    if (i2c->index != 0) return 0;
+    if (i2c_in_irq && ++i2c_level_checks >= 3 && i2c_fifo_count > 0) {
+        i2c_fifo_head = (i2c_fifo_head + 1) % SIM_I2C_FIFO_DEPTH;
+        i2c_fifo_count--;
+        i2c_hw[0].data_cmd = i2c_fifo[i2c_fifo_head];
+        i2c_irq_bytes++;
+    }
+    if (i2c_in_irq) i2c_irq_charge();
+    return i2c_fifo_count;
+}
+
+uint i2c_init(i2c_inst_t* i2c, uint baudrate) { (void)i2c; return baudrate; }
+void i2c_set_slave_mode(i2c_inst_t* i2c, bool slave, uint8_t addr) { (void)i2c; (void)slave; (void)addr; }
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop) {
+    (void)i2c; (void)addr; (void)src; (void)nostop;
+    return (int)len;
+}
+int i2c_read_blocking(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop) {
+    (void)i2c; (void)addr; (void)dst; (void)nostop;
+    return (int)len;
+}
+
+// A byte arrives from the master. Returns false (and raises RX_OVER) when
+// the FIFO is full, like the hardware.
+bool sim_i2c_rx(uint8_t byte) {
+    i2c_hw_t* hw = &i2c_hw[0];
+    if (i2c_fifo_count == SIM_I2C_FIFO_DEPTH) {
+        hw->intr_stat |= SIM_I2C_INTR_RX_OVER;
+        return false;
+    }
+    i2c_fifo[(i2c_fifo_head + i2c_fifo_count) % SIM_I2C_FIFO_DEPTH] = byte;
+    i2c_fifo_count++;
+    hw->intr_stat |= SIM_I2C_INTR_RX_FULL;
+    return true;
+}
+
+// The master ends the transfer with a STOP
+void sim_i2c_stop(void) {
+    i2c_hw[0].intr_stat |= SIM_I2C_INTR_STOP_DET;
+}
+
+int sim_i2c_fifo_level(void) {
+    return i2c_fifo_count;
+}
+
+bool sim_i2c_irq_pending(void) {
+    return i2c_hw[0].intr_stat != 0;
+}
+
+void sim_i2c_set_cost(uint32_t base_ns, uint32_t byte_ns) {
+    i2c_base_ns = base_ns;
+    i2c_byte_ns = byte_ns;
+}
+
+// Run the I2C IRQ handler and return the bytes it read. Reads of data_cmd
+// cannot be trapped on the host, so the FIFO follows the handler's access
+// pattern instead: one level check on entry, then check-read pairs until
+// the FIFO is empty. From the third level check on, each check pops the
+// byte the previous read returned.
+int sim_i2c_irq(void (*handler)(void)) {
+    i2c_hw_t* hw = &i2c_hw[0];
+    i2c_in_irq = true;
+    i2c_level_checks = 0;
+    i2c_irq_bytes = 0;
+    i2c_irq_start_us = fake_us;
+    if (i2c_fifo_count > 0) hw->data_cmd = i2c_fifo[i2c_fifo_head];
+    handler();
+    i2c_in_irq = false;
+    
+    // Level-triggered RX_FULL follows the FIFO; the handler cleared the rest
+    hw->intr_stat = (i2c_fifo_count > 0) ? SIM_I2C_INTR_RX_FULL : 0;
+    return i2c_irq_bytes;
+}
@@ -0,0 +1,52 @@
+#ifndef SIM_SDK_H
+#define SIM_SDK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Host simulation of the RP2040 environment for the tests in this directory.
+//
+// sim_sdk.c   stdio, pins, IRQ/core/lock stubs and the I2C slave FIFO
+// sim_clock.c microsecond clock: manual, or host CPU time scaled to the RP2040
+// fake_display.c  ST7796 API drawing into a framebuffer (no bus timing)
+// sim_panel.c     SPI/DMA/panel model under the real st7796_driver.c
+// sim_flash.c     RAM flash region for flash_history.c (sim_flash.h)
+
+#define SIM_CLK_SYS_HZ 125000000
+#define SIM_IN_SIZE 4096
+#define SIM_OUT_SIZE (1 << 20)
+
+// USB serial
+extern uint8_t sim_out[SIM_OUT_SIZE];
+extern int sim_out_len;
+extern bool sim_echo;
+void sim_input(const void* data, int len);
+void sim_output_clear(void);
+
+// I2C slave (I2C0): 16-byte RX FIFO and the interrupt bits the handler reads
+#define SIM_I2C_FIFO_DEPTH 16
+#define SIM_I2C_INTR_RX_OVER (1u << 1)
+#define SIM_I2C_INTR_RX_FULL (1u << 2)
+#define SIM_I2C_INTR_STOP_DET (1u << 9)
+bool sim_i2c_rx(uint8_t byte);
+void sim_i2c_stop(void);
+int sim_i2c_fifo_level(void);
+bool sim_i2c_irq_pending(void);
+int sim_i2c_irq(void (*handler)(void));
+void sim_i2c_set_cost(uint32_t base_ns, uint32_t byte_ns);
+
+// Clock. With scale 0 time only moves when the test (or a sleep) advances
+// it. With a scale, host CPU time spent in firmware code counts too,
+// multiplied by the scale (the RP2040 at 125 MHz runs this code about 30x
+// slower than a desktop core); sim_clock_exclude() keeps model bookkeeping
+// out of it.
+extern uint64_t fake_us;
+void sim_clock_set_scale(double scale);
+void sim_clock_advance(uint64_t us);
+void sim_clock_advance_to(uint64_t us);
+uint64_t sim_clock_now(void);
+void sim_clock_exclude_begin(void);
+void sim_clock_exclude_end(void);
+double sim_host_ns(void);
+
+#endif // SIM_SDK_H
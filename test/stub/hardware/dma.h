@@ -0,0 +1,24 @@
+#ifndef STUB_HARDWARE_DMA_H
+#define STUB_HARDWARE_DMA_H
+
+#include "pico/stdlib.h"
+
+enum dma_channel_transfer_size { DMA_SIZE_8, DMA_SIZE_16, DMA_SIZE_32 };
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+int dma_claim_unused_channel(bool required);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config* c, bool incr);
+void channel_config_set_write_increment(dma_channel_config* c, bool incr);
+void channel_config_set_dreq(dma_channel_config* c, uint dreq);
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger);
+void dma_channel_wait_for_finish_blocking(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_abort(uint channel);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef STUB_HARDWARE_FLASH_H
+#define STUB_HARDWARE_FLASH_H
+
+#include "pico/stdlib.h"
+
+#define XIP_BASE 0x10000000
+#define FLASH_SECTOR_SIZE 4096
+#define FLASH_PAGE_SIZE 256
+
+// Not backed on the host: tests pass a RAM backend to flash_history_init()
+void flash_range_erase(uint32_t offset, size_t count);
+void flash_range_program(uint32_t offset, const uint8_t* data, size_t count);
+
+#endif
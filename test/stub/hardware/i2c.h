@@ -0,0 +1,29 @@
+#ifndef STUB_HARDWARE_I2C_H
+#define STUB_HARDWARE_I2C_H
+
+#include "pico/stdlib.h"
+
+// DW_apb_i2c register block, in RP2040 order
+typedef struct {
+    volatile uint32_t con, tar, sar, _pad0, data_cmd;
+    volatile uint32_t ss_scl_hcnt, ss_scl_lcnt, fs_scl_hcnt, fs_scl_lcnt, _pad1[2];
+    volatile uint32_t intr_stat, intr_mask, raw_intr_stat, rx_tl, tx_tl;
+    volatile uint32_t clr_intr, clr_rx_under, clr_rx_over, clr_tx_over, clr_rd_req, clr_tx_abrt;
+    volatile uint32_t clr_rx_done, clr_activity, clr_stop_det, clr_start_det, clr_gen_call;
+    volatile uint32_t enable, status, txflr, rxflr, sda_hold, tx_abrt_source, slv_data_nack_only;
+    volatile uint32_t dma_cr, dma_tdlr, dma_rdlr, sda_setup, ack_general_call, enable_status, fs_spklen;
+} i2c_hw_t;
+
+typedef struct i2c_inst i2c_inst_t;
+extern i2c_inst_t i2c0_inst, i2c1_inst;
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+
+i2c_hw_t* i2c_get_hw(i2c_inst_t* i2c);
+size_t i2c_get_read_available(i2c_inst_t* i2c);
+uint i2c_init(i2c_inst_t* i2c, uint baudrate);
+void i2c_set_slave_mode(i2c_inst_t* i2c, bool slave, uint8_t addr);
+int i2c_write_blocking(i2c_inst_t* i2c, uint8_t addr, const uint8_t* src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t* i2c, uint8_t addr, uint8_t* dst, size_t len, bool nostop);
+
+#endif
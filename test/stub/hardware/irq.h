@@ -0,0 +1,14 @@
+#ifndef STUB_HARDWARE_IRQ_H
+#define STUB_HARDWARE_IRQ_H
+
+#include "pico/stdlib.h"
+
+#define DMA_IRQ_0 11
+#define I2C0_IRQ 23
+#define I2C1_IRQ 24
+
+void irq_set_enabled(uint num, bool enabled);
+void irq_set_exclusive_handler(uint num, void (*handler)(void));
+void irq_set_priority(uint num, uint8_t priority);
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef STUB_HARDWARE_RESETS_H
+#define STUB_HARDWARE_RESETS_H
+
+#include "pico/stdlib.h"
+
+#define RESET_I2C0 3
+#define RESET_I2C1 4
+
+void reset_block(uint32_t bits);
+void unreset_block(uint32_t bits);
+void unreset_block_wait(uint32_t bits);
+
+#endif
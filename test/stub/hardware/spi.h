@@ -0,0 +1,33 @@
+#ifndef STUB_HARDWARE_SPI_H
+#define STUB_HARDWARE_SPI_H
+
+#include "pico/stdlib.h"
+
+typedef struct spi_inst spi_inst_t;
+extern spi_inst_t spi0_inst, spi1_inst;
+#define spi0 (&spi0_inst)
+#define spi1 (&spi1_inst)
+
+typedef enum { SPI_CPOL_0, SPI_CPOL_1 } spi_cpol_t;
+typedef enum { SPI_CPHA_0, SPI_CPHA_1 } spi_cpha_t;
+typedef enum { SPI_LSB_FIRST, SPI_MSB_FIRST } spi_order_t;
+
+// PL022 register block
+typedef struct {
+    volatile uint32_t cr0, cr1, dr, sr, cpsr, imsc, ris, mis, icr, dmacr;
+} spi_hw_t;
+
+#define SPI_SSPICR_RORIC_BITS 0x1
+
+uint spi_init(spi_inst_t* spi, uint baudrate);
+void spi_deinit(spi_inst_t* spi);
+uint spi_set_baudrate(spi_inst_t* spi, uint baudrate);
+void spi_set_format(spi_inst_t* spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t order);
+spi_hw_t* spi_get_hw(spi_inst_t* spi);
+uint spi_get_dreq(spi_inst_t* spi, bool is_tx);
+bool spi_is_busy(spi_inst_t* spi);
+bool spi_is_readable(spi_inst_t* spi);
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len);
+int spi_read_blocking(spi_inst_t* spi, uint8_t repeated_tx_data, uint8_t* dst, size_t len);
+
+#endif
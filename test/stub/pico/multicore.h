@@ -0,0 +1,10 @@
+#ifndef STUB_PICO_MULTICORE_H
+#define STUB_PICO_MULTICORE_H
+
+#include "pico/stdlib.h"
+
+// Core 1 is never launched on the host; tests call its functions directly
+void multicore_reset_core1(void);
+void multicore_launch_core1(void (*entry)(void));
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef STUB_PICO_MUTEX_H
+#define STUB_PICO_MUTEX_H
+
+#include "pico/stdlib.h"
+
+typedef struct {
+    volatile int owner;
+} mutex_t;
+
+void mutex_init(mutex_t* mtx);
+bool mutex_try_enter(mutex_t* mtx, uint32_t* owner_out);
+void mutex_enter_blocking(mutex_t* mtx);
+void mutex_exit(mutex_t* mtx);
+
+#endif
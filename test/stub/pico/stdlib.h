@@ -0,0 +1,62 @@
+#ifndef STUB_PICO_STDLIB_H
+#define STUB_PICO_STDLIB_H
+
+// Host stand-ins for the parts of the Pico SDK the firmware uses. Time,
+// stdio and pins are implemented by sim_sdk.c plus either sim_clock.c
+// (manual clock) or sim_panel.c (timed SPI/DMA/panel model).
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define PICO_DEFAULT_LED_PIN 25
+#define PICO_SDK_VERSION_STRING "host"
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#define PICO_ERROR_TIMEOUT -1
+
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+#define GPIO_IRQ_EDGE_FALL 4
+#define GPIO_IRQ_EDGE_RISE 8
+
+enum gpio_function { GPIO_FUNC_SPI, GPIO_FUNC_I2C, GPIO_FUNC_SIO, GPIO_FUNC_PIO0 };
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t events);
+
+absolute_time_t get_absolute_time(void);
+uint32_t to_ms_since_boot(absolute_time_t t);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+void busy_wait_us_32(uint32_t us);
+
+void stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+void stdio_flush(void);
+void tight_loop_contents(void);
+
+void gpio_init(uint pin);
+void gpio_set_dir(uint pin, bool out);
+void gpio_put(uint pin, bool value);
+bool gpio_get(uint pin);
+void gpio_pull_up(uint pin);
+void gpio_disable_pulls(uint pin);
+void gpio_set_function(uint pin, enum gpio_function fn);
+void gpio_set_irq_enabled_with_callback(uint pin, uint32_t events, bool enabled, gpio_irq_callback_t callback);
+void gpio_set_irq_enabled(uint pin, uint32_t events, bool enabled);
+
+uint get_core_num(void);
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+void __dmb(void);
+void __wfe(void);
+void __sev(void);
+
+#endif
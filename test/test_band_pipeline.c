@@ -0,0 +1,127 @@
+// Band pipeline on the timed panel model (sim_panel.c): the real driver
+// sends every blit and fill over modeled SPI and DMA at 32 MHz, DMA reads
+// its source when the burst completes, and CPU time is host time x30. This
+// file is built twice: test_band_pipeline with the two composition bands
+// and test_band_pipeline_sync with RENDER_BANDS=1. In both, after every
+// frame the panel must show exactly what the composer (or, for the split
+// layout, the rings) holds, so a band reused while its burst is still in
+// flight fails the test. Prints per scenario the firmware's own frame
+// figures (render time including the last transfer, DMA wait and the
+// header's U cpu/spi shares), averaged over the frames; compare the two
+// runs. Frames are bus bound, so these move by a few percent with host load.
+#define main device_main
+#include "i2c_test_device.c"
+#undef main
+#include "sim_sdk.h"
+#include "sim_panel.h"
+#include <stdlib.h>
+
+#define PACKETS_PER_FRAME 3
+#define BENCH_FRAMES 30
+#define CPU_SCALE 30.0
+
+static uint8_t sequence[SPECTRO_CHANNELS];
+static int failures = 0;
+
+static void channel_packet(int ch, int k) {
+    rx_buffer[0] = CHANNEL_PACKET_HEADER;
+    rx_buffer[1] = ch;
+    rx_buffer[2] = sequence[ch]++;
+    for (int i = 0; i < NUM_FREQ_BINS; i++) {
+        rx_buffer[3 + i] = (rand() % 4 == 0) ? rand() % 200 : (i * 7 + k / 8 + ch * 50) % 200;
+    }
+    process_packet();
+}
+
+static void receive(int channels, int packets) {
+    for (int k = 0; k < packets; k++) {
+        for (int c = 0; c < channels; c++) channel_packet(c, k);
+    }
+}
+
+// Spectrogram area of the panel against the composer (single layout)
+static int diff_composed(void) {
+    static const uint8_t* rows[SPECTROGRAM_DEPTH];
+    uint16_t line[SPECTRO_W];
+    int bad = 0;
+    history_rows_build(view_source, view_source_head(), rows);
+    for (int py = 0; py < SPECTRO_VISIBLE_H; py++) {
+        compose_spectro_row(py, rows, line);
+        for (int x = 0; x < SPECTRO_W; x++) {
+            if (sim_panel_fb[SPECTRO_Y + py][x] != line[x]) bad++;
+        }
+    }
+    return bad;
+}
+
+// Pane rows of the panel against the rings (split layout)
+static int diff_panes(void) {
+    static const uint8_t* rows[SPECTROGRAM_DEPTH];
+    int bad = 0;
+    for (int c = 0; c < split_panes; c++) {
+        history_rows_build(spectrogram_buffer[c], spectrogram_head[c], rows);
+        for (int age = 0; age < split_rows; age++) {
+            int y = split_pane_y(c) + age * SPECTRO_PIXEL_H;
+            for (int bin = 0; bin < NUM_FREQ_BINS; bin++) {
+                int x = bin * SPECTRO_PIXEL_W;
+                if (sim_panel_fb[y][x + 1] != palette_lut[store_get(rows[age], bin)]) bad++;
+            }
+        }
+    }
+    return bad;
+}
+
+static void run(const char* name, render_mode_t mode, int channels) {
+    display_params_requested.render_mode = mode;
+    display_params_requested.channels = channels;
+    display_params_pending = true;
+    receive(channels, SPECTROGRAM_DEPTH);
+    update_display();
+
+    uint64_t frame_us = 0, wait_us = 0, cpu_pct = 0, spi_pct = 0;
+    int bad = 0;
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        receive(channels, PACKETS_PER_FRAME);
+        update_display();
+        frame_us += render_us_last_frame;
+        wait_us += dma_wait_us_last_frame;
+        cpu_pct += compose_busy_pct;
+        spi_pct += spi_busy_pct;
+
+        sim_clock_exclude_begin();
+        bad += (channels > 1) ? diff_panes() : diff_composed();
+        sim_clock_exclude_end();
+    }
+    if (bad) {
+        printf("FAIL: %s: %d px on the panel differ from the composer\n", name, bad);
+        failures++;
+    }
+    if (wait_us > frame_us) {
+        printf("FAIL: %s: DMA wait longer than the frame\n", name);
+        failures++;
+    }
+    printf("%-22s %9.1f %9.1f %6u %6u\n", name, frame_us / 1000.0 / BENCH_FRAMES, wait_us / 1000.0 / BENCH_FRAMES,
+           (unsigned)(cpu_pct / BENCH_FRAMES), (unsigned)(spi_pct / BENCH_FRAMES));
+}
+
+int main(void) {
+    srand(7);
+    fake_us = 1000000;
+    spectro_store_init();
+    speech_features_init();
+    st7796_init();
+    st7796_set_rotation(SPECTRO_ROTATION);
+    st7796_fill_screen(COLOR_BLACK);
+    sim_clock_set_scale(CPU_SCALE);
+
+    printf("%d band%s, SPI %u MHz, CPU time x%.0f, %d packets per channel per frame\n", RENDER_BANDS,
+           (RENDER_BANDS > 1) ? "s" : "", SIM_PANEL_SPI_HZ / 1000000, CPU_SCALE, PACKETS_PER_FRAME);
+    printf("%-22s %9s %9s %6s %6s\n", "scenario", "frame ms", "wait ms", "cpu %", "spi %");
+    run("blocks (incremental)", RENDER_BLOCKS, 1);
+    run("linear", RENDER_LINEAR, 1);
+    run("cubic", RENDER_CUBIC, 1);
+    run("4 split panes", RENDER_BLOCKS, SPECTRO_CHANNELS);
+
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+// Per-bin statistics: mean, std and the P² quantiles must keep following
+// the input past 2^24 frames, where an integer running mean or Q8 marker
+// heights stop moving, and must track exact statistics on random input.
+// The STATS header carries the measured update cost; here it is host time,
+// with the clock running at host speed.
+#include "bin_stats.h"
+#include "sim_sdk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#define LONG_RUN_FRAMES (1u << 24)  // Per half of the long run
+#define RANDOM_FRAMES 20000
+#define RANDOM_BINS 40
+
+static int failures = 0;
+static char snapshot[64 * 1024];
+
+typedef struct {
+    unsigned count, min, max, above;
+    double mean, std, p50, p95, p99;
+} row_t;
+
+// Run a whole snapshot with stdout captured into snapshot[]
+static void take_snapshot(void) {
+    fflush(stdout);
+    FILE* capture = tmpfile();
+    int saved = dup(fileno(stdout));
+    dup2(fileno(capture), fileno(stdout));
+    bin_stats_snapshot_begin();
+    while (bin_stats_snapshot_poll()) {
+    }
+    fflush(stdout);
+    dup2(saved, fileno(stdout));
+    close(saved);
+
+    rewind(capture);
+    size_t len = fread(snapshot, 1, sizeof(snapshot) - 1, capture);
+    snapshot[len] = '\0';
+    fclose(capture);
+}
+
+static bool parse_row(int bin, row_t* row) {
+    char prefix[32];
+    snprintf(prefix, sizeof(prefix), "\n%d,%d,", bin, 500 + 125 * bin);
+    const char* line = strstr(snapshot, prefix);
+    if (line == NULL) return false;
+    return sscanf(line + strlen(prefix), "%u,%lf,%lf,%u,%u,%lf,%lf,%lf,%u", &row->count, &row->mean, &row->std,
+                  &row->min, &row->max, &row->p50, &row->p95, &row->p99, &row->above) == 9;
+}
+
+static void expect_near(const char* what, double got, double want, double tolerance) {
+    if (fabs(got - want) > tolerance) {
+        printf("FAIL: %s %.2f, expected %.2f\n", what, got, want);
+        failures++;
+    }
+}
+
+static int compare_u8(const void* a, const void* b) {
+    return *(const uint8_t*)a - *(const uint8_t*)b;
+}
+
+int main(void) {
+    row_t row;
+    uint8_t x;
+
+    // Long run on one bin: 2^24 frames of 10, then 2^24 of 200. Welford
+    // with a Q16 mean froze near 10 in the second half.
+    bin_stats_reset();
+    double t0 = sim_host_ns();
+    x = 10;
+    for (uint32_t i = 0; i < LONG_RUN_FRAMES; i++) bin_stats_update(&x, 1);
+    x = 200;
+    for (uint32_t i = 0; i < LONG_RUN_FRAMES; i++) bin_stats_update(&x, 1);
+    double host_ns = (sim_host_ns() - t0) / (2.0 * LONG_RUN_FRAMES);
+    take_snapshot();
+    if (!parse_row(0, &row)) {
+        printf("FAIL: no snapshot line for bin 0\n");
+        return 1;
+    }
+    printf("long run: %u frames, mean %.2f std %.2f min %u max %u p95 %.2f p99 %.2f, %.0f ns/update (host)\n",
+           row.count, row.mean, row.std, row.min, row.max, row.p95, row.p99, host_ns);
+    if (row.count != 2 * LONG_RUN_FRAMES || row.min != 10 || row.max != 200 || row.above != LONG_RUN_FRAMES) {
+        printf("FAIL: long run counters\n");
+        failures++;
+    }
+    expect_near("long run mean", row.mean, 105.0, 0.02);
+    expect_near("long run std", row.std, 95.0, 0.02);
+    expect_near("long run p95", row.p95, 200.0, 0.1);
+    expect_near("long run p99", row.p99, 200.0, 0.1);
+
+    // Random frames on all bins against exact statistics
+    static uint8_t history[RANDOM_BINS][RANDOM_FRAMES];
+    srand(7);
+    bin_stats_reset();
+    sim_clock_set_scale(1.0);
+    for (int f = 0; f < RANDOM_FRAMES; f++) {
+        uint8_t bins[RANDOM_BINS];
+        for (int b = 0; b < RANDOM_BINS; b++) {
+            // Bin b: spread grows with b, skewed towards low values
+            int v = (rand() % (b * 6 + 16)) * (rand() % 4 + 1) / 4;
+            bins[b] = history[b][f] = (uint8_t)(v > 255 ? 255 : v);
+        }
+        bin_stats_update(bins, RANDOM_BINS);
+    }
+    sim_clock_set_scale(0);
+    take_snapshot();
+    printf("%.*s", (int)(strchr(snapshot, '\n') - snapshot + 1), snapshot);
+    if (strstr(snapshot, "update_us=") == NULL) {
+        printf("FAIL: STATS header without the update cost\n");
+        failures++;
+    }
+    double worst_quantile = 0.0;
+    for (int b = 0; b < RANDOM_BINS; b++) {
+        char what[32];
+        if (!parse_row(b, &row)) {
+            printf("FAIL: no snapshot line for bin %d\n", b);
+            failures++;
+            continue;
+        }
+        double sum = 0, sum_sq = 0;
+        for (int f = 0; f < RANDOM_FRAMES; f++) {
+            sum += history[b][f];
+            sum_sq += (double)history[b][f] * history[b][f];
+        }
+        double mean = sum / RANDOM_FRAMES;
+        double std = sqrt((sum_sq - sum * sum / RANDOM_FRAMES) / (RANDOM_FRAMES - 1));
+        snprintf(what, sizeof(what), "bin %d mean", b);
+        expect_near(what, row.mean, mean, 0.02);  // Printed in 1/256 steps
+        snprintf(what, sizeof(what), "bin %d std", b);
+        expect_near(what, row.std, std, 0.02);
+
+        // P² against the exact order statistics, within 5% of the range
+        qsort(history[b], RANDOM_FRAMES, 1, compare_u8);
+        double range = history[b][RANDOM_FRAMES - 1] - history[b][0];
+        double exact[3] = {history[b][RANDOM_FRAMES / 2], history[b][RANDOM_FRAMES * 95 / 100],
+                           history[b][RANDOM_FRAMES * 99 / 100]};
+        double estimate[3] = {row.p50, row.p95, row.p99};
+        for (int i = 0; i < 3; i++) {
+            double error = fabs(estimate[i] - exact[i]) / range;
+            if (error > worst_quantile) worst_quantile = error;
+        }
+    }
+    printf("random: %d bins x %d frames, worst quantile error %.1f%% of the range\n", RANDOM_BINS, RANDOM_FRAMES,
+           100.0 * worst_quantile);
+    if (worst_quantile > 0.05) {
+        printf("FAIL: P² quantiles too far from the exact ones\n");
+        failures++;
+    }
+
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
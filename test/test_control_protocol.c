@@ -0,0 +1,130 @@
+// Control frame parser: a frame longer than CONTROL_MAX_PAYLOAD is NAKed and
+// skipped whole, so command letters in its payload never reach the text
+// handler. A frame cut short is dropped after the inter-byte timeout, and
+// valid frames and text around rejected ones still get through.
+#include "control_protocol.h"
+#include "sim_sdk.h"
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+static char text_seen[256];
+static int text_count = 0;
+static int commands_seen = 0;
+static uint8_t last_cmd = 0;
+
+void control_handle_text(char c) {
+    if (text_count < (int)sizeof(text_seen) - 1) text_seen[text_count++] = c;
+    text_seen[text_count] = '\0';
+}
+
+void control_handle_command(uint8_t cmd, const uint8_t* payload, uint16_t len) {
+    (void)payload;
+    (void)len;
+    commands_seen++;
+    last_cmd = cmd;
+}
+
+static uint8_t crc8(const uint8_t* data, int len) {
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Send a request frame; payload bytes repeat the given text
+static void send_frame(uint8_t cmd, uint16_t len, const char* fill, bool with_crc) {
+    static uint8_t frame[4 + 1024 + 1];
+    frame[0] = CONTROL_SOF;
+    frame[1] = cmd;
+    frame[2] = len & 0xFF;
+    frame[3] = len >> 8;
+    for (int i = 0; i < len; i++) {
+        frame[4 + i] = fill[i % strlen(fill)];
+    }
+    frame[4 + len] = crc8(&frame[1], 3 + len);
+    sim_input(frame, 4 + len + (with_crc ? 1 : 0));
+}
+
+// Main-loop passes, 1 ms apart, enough to drain the given number of bytes
+// (32 per pass) without a gap that would trip the frame timeout
+static void pump(int bytes) {
+    for (int i = 0; i < bytes / 32 + 2; i++) {
+        control_usb_task();
+        control_poll();
+        sim_clock_advance(1000);
+    }
+}
+
+static int naks_sent(uint8_t error) {
+    int naks = 0;
+    for (int i = 0; i + 5 < sim_out_len; i++) {
+        if (sim_out[i] == CONTROL_RESPONSE_SOF && sim_out[i + 1] == CMD_NAK && sim_out[i + 5] == error) naks++;
+    }
+    return naks;
+}
+
+static void expect(const char* what, bool ok) {
+    if (!ok) {
+        printf("FAIL: %s (text \"%s\", %d commands, last 0x%02X, %d length NAKs)\n", what, text_seen,
+               commands_seen, last_cmd, naks_sent(CONTROL_ERR_LENGTH));
+        failures++;
+    }
+}
+
+int main(void) {
+    // Oversized frame full of command letters, then a PING and a text command
+    send_frame(CMD_SET_PARAM, 300, "srtfpc", true);
+    send_frame(CMD_PING, 0, "", true);
+    sim_input("s", 1);
+    pump(305 + 5 + 1);
+    expect("oversized frame skipped", strcmp(text_seen, "s") == 0);
+    expect("one length NAK", naks_sent(CONTROL_ERR_LENGTH) == 1);
+    expect("PING after the oversized frame", commands_seen == 1 && last_cmd == CMD_PING);
+
+    // Largest possible length: 64 KiB of letters are skipped too
+    text_count = 0;
+    text_seen[0] = '\0';
+    sim_output_clear();
+    for (int sent = 0; sent < 65535 + 5; ) {
+        int chunk = (65535 + 5 - sent < 1000) ? 65535 + 5 - sent : 1000;
+        if (sent == 0) {
+            uint8_t header[4] = {CONTROL_SOF, CMD_GET_PARAM, 0xFF, 0xFF};
+            sim_input(header, 4);
+            chunk = 4;
+        } else {
+            static char letters[1000];
+            memset(letters, 'r', sizeof(letters));
+            sim_input(letters, chunk);
+        }
+        sent += chunk;
+        pump(chunk);
+    }
+    sim_input("t", 1);
+    pump(1);
+    expect("64 KiB frame skipped", strcmp(text_seen, "t") == 0);
+
+    // Oversized frame cut short: the timeout ends the discard
+    text_count = 0;
+    text_seen[0] = '\0';
+    send_frame(CMD_SET_PARAM, 500, "srtfpc", false);
+    pump(504);
+    sim_clock_advance((CONTROL_FRAME_TIMEOUT_MS + 1) * 1000);
+    sim_input("r", 1);
+    pump(1);
+    expect("cut frame dropped after the timeout", strcmp(text_seen, "r") == 0);
+
+    // Frames within the limit still work
+    int before = commands_seen;
+    send_frame(CMD_GET_PARAM, 1, "\x01", true);
+    pump(6);
+    expect("valid frame", commands_seen == before + 1 && last_cmd == CMD_GET_PARAM);
+
+    printf("%d frames, %d CRC errors, text \"%s\"\n", control_frames_ok, control_crc_errors, text_seen);
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,170 @@
+// Staged display recovery under injected panel faults, on the real driver
+// over the panel model (sim_panel.c, CPU time at 30x the host's). A burst
+// that never completes with the panel's registers lost takes the soft
+// resync: no reset pulse, frame memory kept. A panel wedged until a reset
+// pulse takes the full reset and comes back; a dead one takes it and counts
+// as failed. Without readback recovery always resets. In every case the first frame afterwards
+// puts the same spectrogram back on the panel (also in the split and scroll
+// layouts). Prints stage, counters and recovery time per fault.
+#define main device_main
+#include "i2c_test_device.c"
+#undef main
+#include "sim_sdk.h"
+#include "sim_panel.h"
+#include <stdlib.h>
+
+#define CPU_SCALE 30.0
+
+static uint8_t sequence[SPECTRO_CHANNELS];
+static uint16_t before[SIM_PANEL_SIZE][SIM_PANEL_SIZE];
+static uint16_t shown[SIM_PANEL_SIZE][SIM_PANEL_SIZE];
+static int failures = 0;
+
+static void expect(const char* what, bool ok) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static void channel_packet(int ch, int k) {
+    rx_buffer[0] = CHANNEL_PACKET_HEADER;
+    rx_buffer[1] = ch;
+    rx_buffer[2] = sequence[ch]++;
+    for (int i = 0; i < NUM_FREQ_BINS; i++) {
+        rx_buffer[3 + i] = (rand() % 4 == 0) ? rand() % 200 : (i * 7 + k / 8 + ch * 50) % 200;
+    }
+    process_packet();
+}
+
+static void receive(int channels, int packets) {
+    for (int k = 0; k < packets; k++) {
+        for (int c = 0; c < channels; c++) channel_packet(c, k);
+    }
+}
+
+// Rows [y0, y1) and columns [0, w) the panel shows against the snapshot
+static bool panel_same(int y0, int y1, int w) {
+    sim_panel_display(shown);
+    for (int y = y0; y < y1; y++) {
+        if (memcmp(before[y], shown[y], w * sizeof(uint16_t)) != 0) return false;
+    }
+    return true;
+}
+
+static void snapshot(void) {
+    sim_panel_display(before);
+}
+
+// Watchdog recovery and the replay frame; expect the given stage, a failed
+// readback or not, and whether the panel saw a reset pulse
+static void recover(const char* name, uint8_t stage, bool failed, bool reset) {
+    uint32_t soft = recovery_soft_count, hard = recovery_hard_count, lost = recovery_failed_count;
+    uint32_t resets = sim_panel_resets;
+    char what[96];
+
+    recover_display();
+    update_display();
+
+    snprintf(what, sizeof(what), "%s: stage %u, expected %u", name, recovery_stage, stage);
+    expect(what, recovery_stage == stage);
+    snprintf(what, sizeof(what), "%s: counters", name);
+    expect(what, recovery_soft_count - soft == (stage == RECOVERY_SOFT) &&
+                 recovery_hard_count - hard == (stage == RECOVERY_HARD) &&
+                 recovery_failed_count - lost == failed);
+    snprintf(what, sizeof(what), "%s: reset pulse", name);
+    expect(what, (sim_panel_resets != resets) == reset);
+    snprintf(what, sizeof(what), "%s: replay frame done", name);
+    expect(what, !recovery_replay_pending);
+    printf("%-24s %5s %5u %5u %6u %9.1f\n", name, (stage == RECOVERY_SOFT) ? "soft" : "hard",
+           recovery_soft_count, recovery_hard_count, recovery_failed_count, recovery_last_us / 1000.0);
+}
+
+int main(void) {
+    srand(7);
+    fake_us = 10000000;
+    spectro_store_init();
+    speech_features_init();
+    st7796_init();
+    st7796_set_rotation(SPECTRO_ROTATION);
+    st7796_fill_screen(COLOR_BLACK);
+    display_readback = st7796_verify();
+    expect("boot readback", display_readback);
+    sim_clock_set_scale(CPU_SCALE);
+
+    display_params_requested.channels = 1;
+    display_params_pending = true;
+    receive(1, SPECTROGRAM_DEPTH);
+    update_display();
+    snapshot();
+    int area_y0 = SPECTRO_Y, area_y1 = SPECTRO_Y + SPECTRO_VISIBLE_H;
+
+    printf("%-24s %5s %5s %5s %6s %9s\n", "fault", "stage", "soft", "hard", "failed", "ms");
+    sim_panel_hang_dma();
+    sim_panel_glitch();
+    recover("hung DMA, lost MADCTL", RECOVERY_SOFT, false, false);
+    expect("soft: spectrogram back", panel_same(area_y0, area_y1, SCREEN_W));
+    uint32_t soft_us = recovery_last_us;
+
+    sim_panel_fault = SIM_PANEL_WEDGED;
+    recover("wedged panel", RECOVERY_HARD, false, true);
+    expect("wedged: spectrogram back", panel_same(area_y0, area_y1, SCREEN_W));
+    expect("soft resync faster than the full reset", soft_us < recovery_last_us);
+
+    sim_panel_fault = SIM_PANEL_DEAD;
+    recover("dead panel", RECOVERY_HARD, true, true);
+
+    sim_panel_fault = SIM_PANEL_OK;
+    sim_panel_glitch();
+    recover("healthy again", RECOVERY_SOFT, false, false);
+    expect("healthy: spectrogram back", panel_same(area_y0, area_y1, SCREEN_W));
+
+    display_readback = false;
+    recover("no readback", RECOVERY_HARD, false, true);
+    expect("no readback: spectrogram back", panel_same(area_y0, area_y1, SCREEN_W));
+    display_readback = true;
+
+    // Split layout: every pane row comes back
+    display_params_requested.channels = SPECTRO_CHANNELS;
+    display_params_pending = true;
+    receive(SPECTRO_CHANNELS, SPECTROGRAM_DEPTH);
+    update_display();
+    snapshot();
+    sim_panel_hang_dma();
+    sim_panel_glitch();
+    recover("split, hung DMA", RECOVERY_SOFT, false, false);
+    expect("split soft: panes back", panel_same(area_y0, area_y1, SPECTRO_W));
+    sim_panel_fault = SIM_PANEL_WEDGED;
+    recover("split, wedged panel", RECOVERY_HARD, false, true);
+    expect("split hard: panes back", panel_same(area_y0, area_y1, SPECTRO_W));
+
+    display_params_requested.channels = 1;
+    display_params_pending = true;
+    update_display();
+
+#if SCROLL_SUPPORTED
+    // Scroll layout: the waterfall comes back at scroll start 0, so compare
+    // frame-memory lines as the panel shows them. Columns older than the
+    // displayed depth stay on the panel until overwritten; a redraw clears
+    // them, so only the displayed depth is compared.
+    display_params_requested.scroll_mode = 1;
+    display_params_pending = true;
+    update_display();
+    receive(1, 7);
+    update_display();
+    snapshot();
+    int depth_line = SCROLL_AREA_W - spectrogram_depth * SCROLL_COLUMN_W;
+    if (depth_line < 0) depth_line = 0;
+    sim_panel_hang_dma();
+    sim_panel_glitch();
+    recover("scroll, hung DMA", RECOVERY_SOFT, false, false);
+    expect("scroll soft: waterfall back", panel_same(depth_line, SCROLL_AREA_W, LCD_WIDTH));
+    sim_panel_fault = SIM_PANEL_WEDGED;
+    recover("scroll, wedged panel", RECOVERY_HARD, false, true);
+    expect("scroll hard: waterfall back", panel_same(depth_line, SCROLL_AREA_W, LCD_WIDTH));
+#endif
+
+    printf("longest recovery %.1f ms, %u reset pulses\n", recovery_max_us / 1000.0, sim_panel_resets);
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+// Interpolating renderer: table sanity and ns/pixel of the compose loop.
+// For every render mode, frequency warp and time interpolation setting the
+// full spectrogram is redrawn repeatedly with pixel stores dropped, and the
+// host time of render_tiles is divided by the pixels it composed. The
+// firmware's own counter (frame_compose_us, shown as NS/PX) is read through
+// the host clock as well. Every configuration must match the composer.
+#include "spectro_render.h"
+#include "st7796_driver.h"
+#include "fake_display.h"
+#include "sim_sdk.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_FRAMES 40
+
+static uint8_t ring[SPECTROGRAM_DEPTH][STORE_ROW_BYTES];
+static int ring_head = 0;
+static const uint8_t* rows[SPECTROGRAM_DEPTH];
+static int failures = 0;
+
+static const char* mode_names[] = {"blocks", "linear", "cubic"};
+static const char* warp_names[] = {"linear", "mel", "log"};
+
+static void fill_ring(int (*value)(int bin, int row)) {
+    uint8_t bins[NUM_FREQ_BINS];
+    for (int r = 0; r < SPECTROGRAM_DEPTH; r++) {
+        for (int i = 0; i < NUM_FREQ_BINS; i++) {
+            bins[i] = value(i, r);
+        }
+        store_pack_row(bins, ring[ring_head]);
+        ring_head = (ring_head + 1) % SPECTROGRAM_DEPTH;
+    }
+    history_rows_build(ring, ring_head, rows);
+}
+
+static int random_value(int bin, int row) {
+    (void)row;
+    return (bin > 5 && bin < 25) ? rand() % 256 : rand() % 16;
+}
+
+// Full redraw with the fixed color scale of the sanity checks
+static uint32_t redraw(void) {
+    tile_hash_valid = false;
+    frame_compose_us = 0;
+    frame_composed_pixels = 0;
+    render_palette_update(255);
+    return render_tiles(rows, 255);
+}
+
+static int diff_composed(void) {
+    uint16_t line[SPECTRO_W];
+    int bad = 0;
+    for (int py = 0; py < SPECTRO_VISIBLE_H; py++) {
+        compose_spectro_row(py, rows, line);
+        for (int x = 0; x < SPECTRO_W; x++) {
+            if (fb[SPECTRO_Y + py][x] != line[x]) bad++;
+        }
+    }
+    return bad;
+}
+
+// Frequency and time tables: monotonic, in range, weights summing to 1.0
+static void check_tables(const char* what) {
+    int bad = 0;
+    for (int x = 0; x < SPECTRO_W; x++) {
+        if (interp_x_bin[x] >= NUM_FREQ_BINS) bad++;
+        if (x > 0 && (interp_x_bin[x] << 8 | interp_x_frac[x]) < (interp_x_bin[x - 1] << 8 | interp_x_frac[x - 1])) bad++;
+    }
+    for (int y = 0; y < SPECTRO_H; y++) {
+        if (interp_y_age[y] + (interp_y_frac[y] ? 1 : 0) >= spectrogram_depth) bad++;
+        if (y > 0 && (interp_y_age[y] << 8 | interp_y_frac[y]) < (interp_y_age[y - 1] << 8 | interp_y_frac[y - 1])) bad++;
+    }
+    for (int f = 0; f < 256; f++) {
+        if (cubic_weights[f][0] + cubic_weights[f][1] + cubic_weights[f][2] + cubic_weights[f][3] != 256) bad++;
+    }
+    if (bad) {
+        printf("FAIL: %s: %d interpolation table entries out of order or range\n", what, bad);
+        failures++;
+    }
+}
+
+int main(void) {
+    spectro_store_init();
+    srand(3);
+    fb_clear(COLOR_BLACK);
+
+    // On the linear axis the first and last columns sit on the end bins and
+    // the middle column between the two middle bins
+    fill_ring(random_value);
+    render_mode = RENDER_LINEAR;
+    freq_warp = WARP_LINEAR;
+    interp_time = false;
+    view_changed = true;
+    redraw();
+    check_tables("linear axis");
+    int mid = SPECTRO_W / 2;
+    printf("linear axis: x=0 bin %u.%03u, x=%d bin %u.%03u, x=%d bin %u.%03u\n",
+           interp_x_bin[0], interp_x_frac[0] * 1000 / 256, mid, interp_x_bin[mid], interp_x_frac[mid] * 1000 / 256,
+           SPECTRO_W - 1, interp_x_bin[SPECTRO_W - 1], interp_x_frac[SPECTRO_W - 1] * 1000 / 256);
+    if (interp_x_bin[0] != 0 || interp_x_bin[SPECTRO_W - 1] != NUM_FREQ_BINS - 1 ||
+        interp_x_bin[mid] != NUM_FREQ_BINS / 2 - 1) {
+        printf("FAIL: linear frequency table does not span the bins evenly\n");
+        failures++;
+    }
+
+    printf("%-7s %-7s %-5s %9s %8s %9s %9s\n", "mode", "warp", "time", "pixels", "ns/px", "fw ns/px", "frame us");
+    for (int mode = RENDER_BLOCKS; mode <= RENDER_CUBIC; mode++) {
+        for (int warp = WARP_LINEAR; warp <= WARP_LOG; warp++) {
+            for (int time = 0; time < 2; time++) {
+                if (mode == RENDER_BLOCKS && (warp != WARP_LINEAR || time)) continue;  // Tables unused
+                char what[32];
+                snprintf(what, sizeof(what), "%s/%s/%s", mode_names[mode], warp_names[warp], time ? "time" : "-");
+                render_mode = mode;
+                freq_warp = warp;
+                interp_time = time;
+                view_changed = true;
+
+                fb_null = false;
+                redraw();
+                if (mode != RENDER_BLOCKS) check_tables(what);
+                int bad = diff_composed();
+                if (bad) {
+                    printf("FAIL: %s: %d px differ from the composer\n", what, bad);
+                    failures++;
+                }
+
+                // Compose cost: host time per composed pixel, and the
+                // firmware's counter with the clock running at host speed
+                fb_null = true;
+                sim_clock_set_scale(1.0);
+                double host_ns = 0, pixels = 0, fw_us = 0;
+                for (int f = 0; f < BENCH_FRAMES; f++) {
+                    double t0 = sim_host_ns();
+                    redraw();
+                    host_ns += sim_host_ns() - t0;
+                    pixels += (mode == RENDER_BLOCKS) ? (double)SPECTRO_W * SPECTRO_VISIBLE_H : frame_composed_pixels;
+                    fw_us += frame_compose_us;
+                }
+                sim_clock_set_scale(0);
+                fb_null = false;
+                printf("%-7s %-7s %-5s %9.0f %8.2f %9.2f %9.1f\n", mode_names[mode], warp_names[warp],
+                       time ? "yes" : "no", pixels / BENCH_FRAMES, host_ns / pixels,
+                       (mode == RENDER_BLOCKS) ? 0.0 : fw_us * 1000.0 / pixels, host_ns / BENCH_FRAMES / 1000.0);
+            }
+        }
+    }
+
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+// Specialized against generic render path. This file is built twice: as
+// test_render_paths on the specialized renderer and as
+// test_render_paths_generic with RENDER_GENERIC=1 (modulo per row read,
+// whole tile rows, driver-clipped fills). Both must draw exactly what the
+// composer shows; the tables of the two runs are the comparison.
+// Per render mode: host time of render_tiles for a full redraw, for a
+// frame with one new sample (the view scrolls, so every tile is re-sent)
+// and for an idle frame (every tile hashed, none sent), pixel stores
+// dropped. Times are medians; on a shared host they still move by 10-20%
+// between runs. Pixels composed and pixels the driver put on the panel in
+// a full redraw are exact.
+#include "spectro_render.h"
+#include "st7796_driver.h"
+#include "fake_display.h"
+#include "sim_sdk.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK_FRAMES 20
+#define BENCH_FRAMES 2000
+
+static uint8_t ring[SPECTROGRAM_DEPTH][STORE_ROW_BYTES];
+static int ring_head = 0;
+static const uint8_t* rows[SPECTROGRAM_DEPTH];
+static int failures = 0;
+
+static const char* mode_names[] = {"blocks", "linear", "cubic"};
+
+// Speech-like sample: a few loud bins over a quiet floor
+static void push_row(void) {
+    uint8_t bins[NUM_FREQ_BINS];
+    for (int i = 0; i < NUM_FREQ_BINS; i++) {
+        bins[i] = (i > 5 && i < 25) ? rand() % 256 : rand() % 16;
+    }
+    store_pack_row(bins, ring[ring_head]);
+    ring_head = (ring_head + 1) % SPECTROGRAM_DEPTH;
+}
+
+static uint32_t frame(bool full) {
+    if (full) tile_hash_valid = false;
+    history_rows_build(ring, ring_head, rows);
+    return render_tiles(rows, 255);
+}
+
+static int diff_composed(void) {
+    uint16_t line[SPECTRO_W];
+    int bad = 0;
+    for (int py = 0; py < SPECTRO_VISIBLE_H; py++) {
+        compose_spectro_row(py, rows, line);
+        for (int x = 0; x < SPECTRO_W; x++) {
+            if (fb[SPECTRO_Y + py][x] != line[x]) bad++;
+        }
+    }
+    return bad;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double d = *(const double*)a - *(const double*)b;
+    return (d > 0) - (d < 0);
+}
+
+// Median of BENCH_FRAMES frames, in microseconds
+static double bench(bool full, bool new_sample) {
+    static double us[BENCH_FRAMES];
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        if (new_sample) push_row();
+        double t0 = sim_host_ns();
+        frame(full);
+        us[f] = (sim_host_ns() - t0) / 1000.0;
+    }
+    qsort(us, BENCH_FRAMES, sizeof(double), compare_double);
+    return us[BENCH_FRAMES / 2];
+}
+
+int main(void) {
+    spectro_store_init();
+    srand(5);
+    fb_clear(COLOR_BLACK);
+    render_palette_update(255);
+    for (int r = 0; r < SPECTROGRAM_DEPTH; r++) push_row();
+
+    // Table build of the specialized path, paid once per frame
+    double t0 = sim_host_ns();
+    for (int f = 0; f < BENCH_FRAMES; f++) history_rows_build(ring, (ring_head + f) % SPECTROGRAM_DEPTH, rows);
+    double build_us = (sim_host_ns() - t0) / BENCH_FRAMES / 1000.0;
+
+    printf("%s path, %dx%d panel, rows table %.2f us/frame\n", RENDER_GENERIC ? "generic" : "specialized",
+           SCREEN_W, SCREEN_H, build_us);
+    printf("%-7s %9s %9s %9s %10s %10s\n", "mode", "full us", "new us", "idle us", "composed", "on panel");
+    for (int mode = RENDER_BLOCKS; mode <= RENDER_CUBIC; mode++) {
+        render_mode = mode;
+        freq_warp = WARP_LINEAR;
+        interp_time = false;
+        view_changed = true;
+
+        // Full redraw, then incremental frames as the ring wraps
+        fb_null = false;
+        int bad = 0;
+        for (int f = 0; f < CHECK_FRAMES; f++) {
+            if (f > 0) push_row();
+            frame(f == 0);
+            bad += diff_composed();
+        }
+        if (bad) {
+            printf("FAIL: %s: %d px differ from the composer\n", mode_names[mode], bad);
+            failures++;
+        }
+        frame_composed_pixels = 0;
+        fb_pixels_written = 0;
+        frame(true);
+        uint32_t composed = (mode == RENDER_BLOCKS) ? 0 : frame_composed_pixels;
+        uint64_t on_panel = fb_pixels_written;
+        if (frame(false) != 0) {
+            printf("FAIL: %s: tiles re-sent without a new sample\n", mode_names[mode]);
+            failures++;
+        }
+
+        fb_null = true;
+        double full_us = bench(true, false);
+        double new_us = bench(false, true);
+        double idle_us = bench(false, false);
+        fb_null = false;
+        printf("%-7s %9.1f %9.1f %9.1f %10u %10llu\n", mode_names[mode], full_us, new_us, idle_us, composed,
+               (unsigned long long)on_panel);
+    }
+
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
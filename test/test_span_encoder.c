@@ -0,0 +1,207 @@
+// Span encoder bus cost on speech-like and silent input. Speech is
+// synthesized as syllables of three drifting formants with pauses between
+// them; silence is a sparse noise floor. Each frame takes 3 packets and is
+// rendered incrementally, as a full redraw and as a redraw onto a cleared
+// panel. Reported per frame: SPI bytes and bus time, fills and blits, and
+// the pixels that still had to be buffered for a blit. Fills clock their
+// pixels over SPI too, so they save buffering and DMA reads rather than bus
+// bytes; bus bytes drop where black runs are skipped. The panel must match
+// the screenshot composer, and every fill must pay for its window setup.
+#include "spectro_render.h"
+#include "st7796_driver.h"
+#include "fake_display.h"
+#include "sim_sdk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define FRAMES 400
+#define PACKETS_PER_FRAME 3
+#define FILL_MIN_PIXELS (600 / 3)  // Cost model in spectro_render.c
+// Largest run one cell column can form inside a tile (right of the divider).
+// The deep profile's 10 px tall tiles never reach the fill minimum.
+#define COLUMN_RUN_MAX ((SPECTRO_PIXEL_W - 1) * TILE_H)
+
+static uint8_t ring[SPECTROGRAM_DEPTH][STORE_ROW_BYTES];
+static int ring_head = 0;
+static int packet_index = 0;
+
+// One packet of synthetic speech: syllables of 12-20 frames, pauses of 6-14
+static void speech_bins(uint8_t* bins) {
+    static int syllable_left = 0, pause_left = 0, length = 1;
+    static float f1, f2, f3;
+    if (syllable_left == 0 && pause_left == 0) {
+        length = syllable_left = 12 + rand() % 9;
+        pause_left = 6 + rand() % 9;
+        f1 = 3 + rand() % 5;
+        f2 = 10 + rand() % 8;
+        f3 = 22 + rand() % 8;
+    }
+    float env = 0.0f;
+    if (syllable_left > 0) {
+        int t = length - syllable_left;
+        env = sinf(3.14159f * (t + 0.5f) / length);
+        syllable_left--;
+        f1 += 0.05f;
+        f2 += (rand() % 3 - 1) * 0.2f;
+        f3 -= 0.05f;
+    } else {
+        pause_left--;
+    }
+    for (int i = 0; i < NUM_FREQ_BINS; i++) {
+        float v = 200.0f * env * expf(-(i - f1) * (i - f1) / 4.0f)
+                + 140.0f * env * expf(-(i - f2) * (i - f2) / 6.0f)
+                + 80.0f * env * expf(-(i - f3) * (i - f3) / 8.0f);
+        v += (rand() % 6 == 0) ? rand() % 4 : 0;
+        bins[i] = (v > 255.0f) ? 255 : (uint8_t)v;
+    }
+}
+
+static void silence_bins(uint8_t* bins) {
+    for (int i = 0; i < NUM_FREQ_BINS; i++) {
+        bins[i] = (rand() % 40 == 0) ? 1 + rand() % 3 : 0;
+    }
+}
+
+static uint32_t render(const uint8_t** rows) {
+    history_rows_build(ring, ring_head, rows);
+    uint8_t max_code = 0;
+    for (int age = 0; age < spectrogram_depth; age++) {
+        uint8_t row_max = store_row_max(rows[age]);
+        if (row_max > max_code) max_code = row_max;
+    }
+    uint8_t max_value = store_dequant(max_code);
+    if (max_value < 16) max_value = 16;
+    render_palette_update(max_value);
+    frame_bus_bytes = 0;
+    frame_fills = 0;
+    frame_blits = 0;
+    return render_tiles(rows, max_value);
+}
+
+static int diff_composed(const uint8_t** rows) {
+    uint16_t line[SPECTRO_W];
+    int bad = 0;
+    for (int py = 0; py < SPECTRO_VISIBLE_H; py++) {
+        compose_spectro_row(py, rows, line);
+        for (int x = 0; x < SPECTRO_W; x++) {
+            if (fb[SPECTRO_Y + py][x] != line[x]) bad++;
+        }
+    }
+    return bad;
+}
+
+typedef struct {
+    double bus, plain, redraw, cleared, tiles, fills, blits, buffered, fill_share, host_us;
+} cost_t;
+
+// Bus time of a byte count at the panel's SPI clock
+static double bus_us(double bytes) {
+    return bytes * 8.0 * 1e6 / ST7796_SPI_HZ;
+}
+
+static int run(const char* name, void (*source)(uint8_t*), cost_t* cost) {
+    const uint8_t* rows[SPECTROGRAM_DEPTH];
+    uint8_t bins[NUM_FREQ_BINS];
+    int bad = 0;
+    
+    *cost = (cost_t){0};
+    tile_hash_valid = false;
+    render(rows);
+    for (int frame = 0; frame < FRAMES; frame++) {
+        for (int p = 0; p < PACKETS_PER_FRAME; p++, packet_index++) {
+            source(bins);
+            store_pack_row(bins, ring[ring_head]);
+            ring_head = (ring_head + 1) % SPECTROGRAM_DEPTH;
+        }
+        
+        // Incremental frame: dirty tiles only
+        uint64_t pixels_before = fb_pixels_written, fills_before = fb_fill_pixels;
+        double t0 = sim_host_ns();
+        cost->tiles += render(rows);
+        cost->host_us += (sim_host_ns() - t0) / 1000.0;
+        cost->bus += frame_bus_bytes;
+        cost->fills += frame_fills;
+        cost->blits += frame_blits;
+        cost->buffered += (double)(fb_pixels_written - pixels_before) - (double)(fb_fill_pixels - fills_before);
+        bad += diff_composed(rows);
+        
+        // The same rows redrawn from scratch, e.g. after a zoom, against
+        // sending every visible tile as one buffered blit
+        pixels_before = fb_pixels_written;
+        fills_before = fb_fill_pixels;
+        tile_hash_valid = false;
+        render(rows);
+        cost->redraw += frame_bus_bytes;
+        cost->fill_share += (double)(fb_fill_pixels - fills_before) / (double)(fb_pixels_written - pixels_before);
+        for (int ty = 0; ty < TILES_Y; ty++) {
+            if (TILE_VISIBLE_H(ty) == 0) continue;
+            cost->plain += TILES_X * (ST7796_WINDOW_SETUP_BYTES + (double)TILE_W * TILE_VISIBLE_H(ty) * 2);
+        }
+        
+        // Redraw onto a cleared panel, where black runs are skipped
+        fb_clear(COLOR_BLACK);
+        tile_hash_valid = false;
+        spectro_area_black = true;
+        render(rows);
+        cost->cleared += frame_bus_bytes;
+        bad += diff_composed(rows);
+    }
+    
+    cost->bus /= FRAMES;
+    cost->plain /= FRAMES;
+    cost->redraw /= FRAMES;
+    cost->cleared /= FRAMES;
+    cost->tiles /= FRAMES;
+    cost->fills /= FRAMES;
+    cost->blits /= FRAMES;
+    cost->buffered /= FRAMES;
+    cost->fill_share /= FRAMES;
+    cost->host_us /= FRAMES;
+    printf("%-8s frame %7.0f B %6.0f us bus, %5.1f tiles, %5.1f fills, %5.1f blits, %6.0f px buffered, %5.1f us host\n",
+           name, cost->bus, bus_us(cost->bus), cost->tiles, cost->fills, cost->blits, cost->buffered, cost->host_us);
+    printf("%-8s redraw %7.0f B (plain blits %7.0f B, %4.1f%% filled), after clear %7.0f B %6.0f us bus\n",
+           name, cost->redraw, cost->plain, 100.0 * cost->fill_share, cost->cleared, bus_us(cost->cleared));
+    if (bad) {
+        printf("FAIL: %s: %d px differ from the composer\n", name, bad);
+    }
+    return bad;
+}
+
+int main(void) {
+    cost_t speech, silence;
+    int failures = 0;
+    
+    spectro_store_init();
+    srand(5);
+    fb_clear(COLOR_BLACK);
+    
+    failures += run("speech", speech_bins, &speech) != 0;
+    failures += run("silence", silence_bins, &silence) != 0;
+    
+    printf("%u px smallest fill (cost model minimum %u, largest column run %u)\n",
+           fb_min_fill_pixels == UINT32_MAX ? 0 : fb_min_fill_pixels, FILL_MIN_PIXELS, COLUMN_RUN_MAX);
+    if (fb_min_fill_pixels < FILL_MIN_PIXELS) {
+        printf("FAIL: a run below the cost model's minimum went out as a fill\n");
+        failures++;
+    }
+    // Fills still clock every pixel over SPI; what they save is buffering.
+    // Window setups for the extra rectangles must stay a small overhead.
+    if (speech.redraw > 1.1 * speech.plain || silence.redraw > 1.1 * silence.plain) {
+        printf("FAIL: span windows cost more than 10%% over plain tile blits\n");
+        failures++;
+    }
+    if (COLUMN_RUN_MAX >= FILL_MIN_PIXELS &&
+        (silence.fill_share < 0.8 || silence.buffered >= speech.buffered)) {
+        printf("FAIL: silence is not sent mostly as fills\n");
+        failures++;
+    }
+    // (the column dividers are still drawn on every full redraw)
+    if (silence.cleared > 0.25 * silence.plain || silence.cleared >= speech.cleared) {
+        printf("FAIL: black runs are not skipped after a clear\n");
+        failures++;
+    }
+    
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
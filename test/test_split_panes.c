@@ -0,0 +1,166 @@
+// Split-screen panes with 2, 3 and 4 channels receiving (built with
+// SPECTRO_CHANNELS=4). Every pane row shows its channel's ring, newest at
+// the top; an incremental frame leaves the panel as a full redraw does,
+// also after returning to the single layout. A full redraw counts the
+// black fill of the spectrogram area plus every pane row in its bus bytes;
+// an incremental frame counts only the rows it re-sent. Header and status
+// text stays on the screen, clear of the feature bars and of each other
+// (glyphs 5x7 at size 1). Prints rows per
+// pane and bus bytes per frame at 3 packets per channel per frame.
+#define main device_main
+#include "i2c_test_device.c"
+#undef main
+#include "sim_sdk.h"
+#include "fake_display.h"
+#include <stdlib.h>
+
+#define PACKETS_PER_FRAME 3
+#define BENCH_FRAMES 20
+#define SPI_HZ 32000000
+
+static uint8_t sequence[SPECTRO_CHANNELS];
+static uint16_t full_frame[SCREEN_H][SCREEN_W];
+static int failures = 0;
+
+static void expect(const char* what, bool ok) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// One channel packet through the packet path, as the IRQ would queue it
+static void channel_packet(int ch, int k) {
+    rx_buffer[0] = CHANNEL_PACKET_HEADER;
+    rx_buffer[1] = ch;
+    rx_buffer[2] = sequence[ch]++;
+    for (int i = 0; i < NUM_FREQ_BINS; i++) {
+        rx_buffer[3 + i] = (rand() % 4 == 0) ? rand() % 200 : (i * 7 + k / 8 + ch * 50) % 200;
+    }
+    process_packet();
+}
+
+static void receive(int panes, int packets) {
+    for (int k = 0; k < packets; k++) {
+        for (int c = 0; c < panes; c++) channel_packet(c, k);
+    }
+}
+
+static void set_panes(int panes) {
+    display_params_requested.channels = panes;
+    display_params_pending = true;
+    update_display();
+}
+
+// Every pane row on the panel against its channel's ring
+static int diff_panes(void) {
+    static const uint8_t* rows[SPECTROGRAM_DEPTH];
+    int bad = 0;
+    for (int c = 0; c < split_panes; c++) {
+        history_rows_build(spectrogram_buffer[c], spectrogram_head[c], rows);
+        for (int age = 0; age < split_rows; age++) {
+            int y = split_pane_y(c) + age * SPECTRO_PIXEL_H;
+            for (int bin = 0; bin < NUM_FREQ_BINS; bin++) {
+                int x = bin * SPECTRO_PIXEL_W;
+                if (fb[y][x] != COLOR_DARKGRAY || fb[y][x + 1] != palette_lut[store_get(rows[age], bin)]) bad++;
+            }
+        }
+    }
+    return bad;
+}
+
+// Text drawn by the last frames against the screen, the bars and each other
+static int text_overlaps(void) {
+    int bad = 0;
+    for (int i = 0; i < fb_text_count; i++) {
+        fb_text_t* a = &fb_text[i];
+        int size = a->h / 8;
+        int ax1 = a->x + a->w - size, ay1 = a->y + 7 * size;
+        bool on_bars = ax1 > FEATURE_STRIP_X && a->x < SCREEN_W && ay1 > 2 && a->y < SPECTRO_Y - 2;
+        if (ax1 > SCREEN_W || ay1 > SCREEN_H || on_bars) {
+            printf("  '%s' at %d,%d\n", a->text, a->x, a->y);
+            bad++;
+        }
+        for (int j = 0; j < i; j++) {
+            fb_text_t* b = &fb_text[j];
+            int bsize = b->h / 8;
+            if (a->x == b->x && a->y == b->y) continue;  // Redrawn in place
+            if (ax1 > b->x && a->x < b->x + b->w - bsize && ay1 > b->y && a->y < b->y + 7 * bsize) {
+                printf("  '%s' at %d,%d over '%s'\n", a->text, a->x, a->y, b->text);
+                bad++;
+            }
+        }
+    }
+    return bad;
+}
+
+// Current panel against a full redraw of the same rings
+static bool equals_full_redraw(void) {
+    memcpy(full_frame, fb, sizeof(full_frame));
+    split_valid = false;
+    tile_hash_valid = false;
+    update_display();
+    return memcmp(full_frame, fb, sizeof(full_frame)) == 0;
+}
+
+int main(void) {
+    srand(7);
+    fake_us = 1000000;
+    spectro_store_init();
+    speech_features_init();
+    fb_clear(COLOR_BLACK);
+
+    uint32_t row_bytes = ST7796_WINDOW_SETUP_BYTES + SPECTRO_W * SPECTRO_PIXEL_H * 2;
+    uint32_t fill_bytes = ST7796_WINDOW_SETUP_BYTES + SCREEN_W * SPECTRO_VISIBLE_H * 2;
+    printf("%u B per channel, %u B per pane row, %u B area fill\n", (unsigned)CHANNEL_MEMORY_BYTES, row_bytes,
+           fill_bytes);
+    printf("%-5s %5s %10s %10s %10s %8s\n", "panes", "rows", "full B", "frame B", "pane B", "SPI ms");
+
+    for (int panes = 2; panes <= SPECTRO_CHANNELS; panes++) {
+        char what[64];
+        receive(panes, SPECTROGRAM_DEPTH);
+        set_panes(panes);
+        snprintf(what, sizeof(what), "%d panes: pane rows show the rings", panes);
+        expect(what, diff_panes() == 0);
+
+        // Full redraw: area fill plus every pane row
+        split_valid = false;
+        fb_text_clear();
+        update_display();
+        snprintf(what, sizeof(what), "%d panes: status text overlaps", panes);
+        expect(what, text_overlaps() == 0);
+        uint32_t full_bytes = bus_bytes_last_frame;
+        snprintf(what, sizeof(what), "%d panes: full redraw bus bytes", panes);
+        expect(what, split_rows_sent == (uint32_t)(panes * split_rows) &&
+                     full_bytes == fill_bytes + split_rows_sent * row_bytes);
+
+        // Incremental frames as packets arrive
+        uint64_t frame_bytes = 0;
+        for (int f = 0; f < BENCH_FRAMES; f++) {
+            receive(panes, PACKETS_PER_FRAME);
+            update_display();
+            frame_bytes += bus_bytes_last_frame;
+            if (bus_bytes_last_frame != split_rows_sent * row_bytes) {
+                snprintf(what, sizeof(what), "%d panes: incremental bus bytes", panes);
+                expect(what, false);
+            }
+        }
+        snprintf(what, sizeof(what), "%d panes: incremental equals full redraw", panes);
+        expect(what, equals_full_redraw());
+
+        frame_bytes /= BENCH_FRAMES;
+        printf("%-5d %5d %10u %10u %10u %8.1f\n", panes, split_rows, full_bytes, (unsigned)frame_bytes,
+               (unsigned)(frame_bytes / panes), frame_bytes * 8 * 1000.0 / SPI_HZ);
+    }
+
+    // Back to the single layout
+    set_panes(1);
+    receive(1, PACKETS_PER_FRAME);
+    fb_text_clear();
+    update_display();
+    expect("single layout status text overlaps", text_overlaps() == 0);
+    expect("single layout after the panes equals a full redraw", equals_full_redraw());
+
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,368 @@
+// I2C receive path under a replayed stress sweep. The traffic of
+// stress_master.c (pattern packets, junk frames, aborted transfers and
+// packets ending in a repeated START) is replayed byte by byte into the
+// simulated RX FIFO with bus timing, over the master's rate steps at 400 kHz
+// and 1 MHz. The firmware's I2C IRQ handler and the Core 0 main loop run on
+// the modeled RP2040 costs below, so the run is deterministic. Every step
+// reports the device counters, IRQ latency and service time, RX FIFO level
+// and consumer lag; the STRESS lines the firmware printed give its knee.
+//
+// Pattern packets must reach the stress counters only: the history ring,
+// pyramid and speech features stay untouched.
+#define main device_main
+#include "i2c_test_device.c"
+#undef main
+#include "sim_sdk.h"
+#include "stress_pattern.h"
+#include <stdlib.h>
+#include <unistd.h>
+
+// Master traffic, as in stress_master.c
+#define STEP_MS 3000
+#define STEP_PAUSE_MS 1000
+#define JUNK_EVERY 50
+#define ABORT_EVERY 37
+#define ABORT_LENGTH 20
+#define RESTART_EVERY 10
+#define MASTER_GAP_NS 3000  // i2c_write_timeout_us() setup between transfers
+
+static const uint32_t bus_speeds[] = {400000, 1000000};
+static const uint32_t step_rates[] = {60, 120, 250, 400, 600, 800, 1000, 1500, 2000, 2500};
+
+#define NUM_SPEEDS (sizeof(bus_speeds) / sizeof(bus_speeds[0]))
+#define NUM_RATES (sizeof(step_rates) / sizeof(step_rates[0]))
+
+// Device costs at 125 MHz (8 ns per cycle). Nothing else masks or preempts
+// the I2C IRQ in this model.
+#define IRQ_ENTRY_NS 250     // Exception entry to the first handler instruction
+#define IRQ_BASE_NS 2000     // Handler without bytes: status, timestamps, stress sample
+#define IRQ_BYTE_NS 300      // Per byte read from the RX FIFO
+#define PACKET_NS 4000       // process_packet() on a pattern packet
+#define LOOP_PASS_NS 5000    // Main-loop pass with nothing to do (USB poll, control, log)
+#define PRINT_BYTE_NS 500    // printf formatting, per output character
+#define USB_TX_BUFFER 256    // stdio USB TX buffer; printf blocks while it is full
+#define USB_TX_BYTE_NS 1000  // TX buffer drain (~1 MB/s)
+
+#define NEVER UINT64_MAX
+#define MAX_SAMPLES (1 << 20)
+
+// Wire events of the transfer in progress: data bytes, then a STOP (-1)
+typedef struct {
+    uint64_t ns;
+    int byte;
+} wire_event_t;
+
+typedef struct {
+    uint32_t sent, junk, aborted, restarts;
+} step_counters_t;
+
+static wire_event_t wire[STRESS_PACKET_SIZE + 1];
+static int wire_len = 0, wire_pos = 0;
+
+// Master state for the current step
+static bool master_active = false;
+static uint64_t bit_ns;
+static uint64_t step_start_ns, step_period_ns, next_send_ns, bus_free_ns;
+static uint32_t send_index = 0;
+static uint16_t seq = 0;
+static bool bus_held = false;
+static step_counters_t master;
+
+// Core 0
+static uint64_t cpu_ns = 1000000000ull;  // Main loop position
+static uint64_t irq_pending_ns = NEVER;  // When the pending interrupt was raised
+static uint64_t irq_free_ns = 0;         // End of the last handler
+static uint32_t last_pass_ms = 0;
+static uint64_t usb_level = 0, usb_drained_ns = 0;
+
+// Per-step samples
+static uint32_t irq_latency[MAX_SAMPLES], irq_service[MAX_SAMPLES], irq_fifo[MAX_SAMPLES];
+static uint32_t consumer_lag[MAX_SAMPLES];
+static int irq_samples = 0, lag_samples = 0;
+
+static int failures = 0;
+static FILE* out;  // Test output; the firmware's stdout is captured
+
+// Queue one transfer: (repeated) START and address, 9 bit times per byte
+// (8 data bits and the ACK), then STOP and bus free time unless nostop
+static void queue_transfer(const uint8_t* data, int len, bool nostop) {
+    uint64_t t = (next_send_ns > bus_free_ns) ? next_send_ns : bus_free_ns;
+    t += 10 * bit_ns;
+    wire_len = wire_pos = 0;
+    for (int i = 0; i < len; i++) {
+        t += 9 * bit_ns;
+        wire[wire_len++] = (wire_event_t){t, data[i]};
+    }
+    if (nostop) {
+        bus_free_ns = t + MASTER_GAP_NS;
+    } else {
+        t += bit_ns;
+        wire[wire_len++] = (wire_event_t){t, -1};
+        bus_free_ns = t + bit_ns + MASTER_GAP_NS;
+    }
+    bus_held = nostop;
+}
+
+// Next item of the step schedule, as send_next() in stress_master.c
+static void master_send_next(void) {
+    uint8_t packet[STRESS_PACKET_SIZE];
+    uint32_t index = send_index++;
+
+    if (index % JUNK_EVERY == JUNK_EVERY - 1) {
+        stress_pattern_fill(packet, 0xFFFF);
+        packet[0] = STRESS_JUNK_HEADER;
+        queue_transfer(packet, sizeof(packet), false);
+        master.junk++;
+    } else if (index % ABORT_EVERY == ABORT_EVERY - 1) {
+        stress_pattern_fill(packet, 0xFFFF);
+        queue_transfer(packet, ABORT_LENGTH, false);
+        master.aborted++;
+    } else {
+        bool nostop = (index % RESTART_EVERY == RESTART_EVERY - 1);
+        stress_pattern_fill(packet, seq++);
+        queue_transfer(packet, sizeof(packet), nostop);
+        master.sent++;
+        if (nostop) master.restarts++;
+    }
+    next_send_ns += step_period_ns;
+}
+
+// Time of the next wire event, generating transfers as the master would
+static uint64_t next_wire_ns(void) {
+    while (wire_pos == wire_len) {
+        if (!master_active) return NEVER;
+        if (bus_free_ns - step_start_ns >= (uint64_t)STEP_MS * 1000000) {
+            master_active = false;
+            if (bus_held) {
+                // Release the bus; the device counts this byte as aborted
+                uint8_t header = STRESS_JUNK_HEADER;
+                queue_transfer(&header, 1, false);
+                master.aborted++;
+            }
+            continue;
+        }
+        master_send_next();
+    }
+    return wire[wire_pos].ns;
+}
+
+// Deliver wire events and run the IRQ handler up to `end`. Handler time
+// preempts the main loop, so it pushes `end` back; returns the new end.
+static uint64_t run_interrupts(uint64_t end) {
+    while (1) {
+        uint64_t t_wire = next_wire_ns();
+        uint64_t t_irq = NEVER;
+        if (sim_i2c_irq_pending()) {
+            t_irq = ((irq_pending_ns > irq_free_ns) ? irq_pending_ns : irq_free_ns) + IRQ_ENTRY_NS;
+        }
+
+        if (t_wire <= t_irq && t_wire < end) {
+            bool was_pending = sim_i2c_irq_pending();
+            wire_event_t* e = &wire[wire_pos++];
+            if (e->byte < 0) {
+                sim_i2c_stop();
+            } else {
+                sim_i2c_rx((uint8_t)e->byte);
+            }
+            if (!was_pending) irq_pending_ns = e->ns;
+        } else if (t_irq < end) {
+            int level = sim_i2c_fifo_level();
+            fake_us = t_irq / 1000;
+            int bytes = sim_i2c_irq(i2c1_irq_handler);
+            uint64_t cost = IRQ_BASE_NS + (uint64_t)bytes * IRQ_BYTE_NS;
+            if (irq_samples < MAX_SAMPLES) {
+                irq_latency[irq_samples] = (uint32_t)(t_irq - irq_pending_ns);
+                irq_service[irq_samples] = (uint32_t)cost;
+                irq_fifo[irq_samples++] = level;
+            }
+            irq_free_ns = t_irq + cost;
+            irq_pending_ns = irq_free_ns;
+            end += IRQ_ENTRY_NS + cost;
+        } else {
+            return end;
+        }
+    }
+}
+
+static void advance_main(uint64_t ns) {
+    cpu_ns = run_interrupts(cpu_ns + ns);
+}
+
+// Time printf blocks Core 0: formatting, then waiting for USB TX space
+static uint64_t print_cost(long chars) {
+    uint64_t drained = (cpu_ns - usb_drained_ns) / USB_TX_BYTE_NS;
+    usb_level = (drained < usb_level) ? usb_level - drained : 0;
+    uint64_t cost = chars * PRINT_BYTE_NS;
+    usb_level += chars;
+    if (usb_level > USB_TX_BUFFER) {
+        cost += (usb_level - USB_TX_BUFFER) * USB_TX_BYTE_NS;
+        usb_level = USB_TX_BUFFER;
+    }
+    usb_drained_ns = cpu_ns + cost;
+    return cost;
+}
+
+// One pass of the main loop in i2c_test_device.c. Idle passes within the
+// same millisecond have nothing to do and only take their time.
+static void main_loop_pass(void) {
+    fake_us = cpu_ns / 1000;
+    uint32_t now = to_ms_since_boot(get_absolute_time());
+    bool work = false;
+
+    if (packet_ready) {
+        if (lag_samples < MAX_SAMPLES) consumer_lag[lag_samples++] = time_us_32() - packet_ready_us;
+        process_packet();
+        advance_main(PACKET_NS);
+        packet_ready = false;
+        rx_index = 0;
+        work = true;
+    }
+
+    if (work || now != last_pass_ms) {
+        fake_us = cpu_ns / 1000;
+        long before = ftell(stdout);
+        control_usb_task();
+        control_poll();
+        log_drain();
+        stress_rx_counters_t rx = {
+            packet_count, invalid_header_count, aborted_transfer_count,
+            rx_fifo_overflows, rx_dropped_bytes,
+        };
+        stress_report_poll(now, &rx);
+        advance_main(LOOP_PASS_NS + print_cost(ftell(stdout) - before));
+        last_pass_ms = now;
+    } else {
+        advance_main(LOOP_PASS_NS);
+    }
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t percentile(uint32_t* samples, int n, int percent) {
+    if (n == 0) return 0;
+    qsort(samples, n, sizeof(samples[0]), compare_u32);
+    return samples[(int64_t)(n - 1) * percent / 100];
+}
+
+// Sum of a "name=value" field over the firmware's STRESS lines
+static uint32_t report_sum(const char* text, const char* field) {
+    uint32_t sum = 0;
+    for (const char* p = strstr(text, "STRESS offered="); p; p = strstr(p + 1, "STRESS offered=")) {
+        const char* f = strstr(p, field);
+        const char* eol = strchr(p, '\n');
+        if (f && (!eol || f < eol)) sum += strtoul(f + strlen(field), NULL, 10);
+    }
+    return sum;
+}
+
+int main(void) {
+    // Firmware output goes to a file; its size gives the printf cost
+    fflush(stdout);
+    out = fdopen(dup(fileno(stdout)), "w");
+    FILE* capture = tmpfile();
+    dup2(fileno(capture), fileno(stdout));
+
+    sim_i2c_set_cost(IRQ_BASE_NS, IRQ_BYTE_NS);
+    fake_us = cpu_ns / 1000;
+    stress_set_mode(true);
+
+    fprintf(out, "model: IRQ entry %u ns, handler %u + %u ns/byte, packet %u ns, idle pass %u ns, "
+            "printf %u ns/char, USB TX %u B at %u ns/byte\n", IRQ_ENTRY_NS, IRQ_BASE_NS, IRQ_BYTE_NS,
+            PACKET_NS, LOOP_PASS_NS, PRINT_BYTE_NS, USB_TX_BUFFER, USB_TX_BYTE_NS);
+    fprintf(out, "%5s %5s %5s %5s %5s %4s %5s %4s %5s | %18s %8s %4s | %17s\n", "kHz", "rate", "tx/s", "rx/s",
+            "lost", "junk", "abort", "over", "drop", "irq lat p50/99/max", "svc p99", "fifo",
+            "lag us p50/99/max");
+
+    uint32_t total_lost = 0;
+    for (uint32_t s = 0; s < NUM_SPEEDS; s++) {
+        uint32_t knee_lossless = 0, knee_lossy = 0;
+        for (uint32_t r = 0; r < NUM_RATES; r++) {
+            bit_ns = 1000000000ull / bus_speeds[s];
+            step_period_ns = 1000000000ull / step_rates[r];
+            step_start_ns = next_send_ns = bus_free_ns = cpu_ns;
+            send_index = 0;
+            master = (step_counters_t){0};
+            master_active = true;
+            irq_samples = lag_samples = 0;
+            uint32_t packets0 = packet_count, junk0 = invalid_header_count, aborted0 = aborted_transfer_count;
+            uint32_t over0 = rx_fifo_overflows, drop0 = rx_dropped_bytes;
+
+            while (master_active) main_loop_pass();
+            uint64_t step_ns = bus_free_ns - step_start_ns;
+            while (cpu_ns < bus_free_ns + (uint64_t)STEP_PAUSE_MS * 1000000) main_loop_pass();
+
+            uint32_t received = packet_count - packets0;
+            uint32_t lost = master.sent - received;
+            uint32_t junk = invalid_header_count - junk0, aborted = aborted_transfer_count - aborted0;
+            uint32_t over = rx_fifo_overflows - over0, drop = rx_dropped_bytes - drop0;
+            total_lost += lost;
+            uint32_t lat50 = percentile(irq_latency, irq_samples, 50), lat99 = percentile(irq_latency, irq_samples, 99);
+            uint32_t svc99 = percentile(irq_service, irq_samples, 99);
+            uint32_t lag50 = percentile(consumer_lag, lag_samples, 50), lag99 = percentile(consumer_lag, lag_samples, 99);
+            fprintf(out, "%5u %5u %5u %5u %5u %4u %5u %4u %5u | %5u %5u %6u %8u %4u | %5u %5u %5u\n",
+                    bus_speeds[s] / 1000, step_rates[r], (uint32_t)(master.sent * 1000000000ull / step_ns),
+                    (uint32_t)(received * 1000000000ull / step_ns), lost, junk, aborted, over, drop,
+                    lat50, lat99, percentile(irq_latency, irq_samples, 100), svc99,
+                    percentile(irq_fifo, irq_samples, 100), lag50, lag99,
+                    percentile(consumer_lag, lag_samples, 100));
+
+            if (lost == 0 && drop == 0) {
+                if (knee_lossy == 0) knee_lossless = step_rates[r];
+                if (junk != master.junk || aborted != master.aborted) {
+                    fprintf(out, "FAIL: lossless step counted junk %u/%u, aborted %u/%u\n", junk, master.junk,
+                            aborted, master.aborted);
+                    failures++;
+                }
+            } else if (knee_lossy == 0) {
+                knee_lossy = step_rates[r];
+            }
+            if (step_rates[r] <= 250 && (lost || drop)) {
+                fprintf(out, "FAIL: loss at %u pkt/s\n", step_rates[r]);
+                failures++;
+            }
+            if (over) {
+                fprintf(out, "FAIL: RX FIFO overrun at %u pkt/s\n", step_rates[r]);
+                failures++;
+            }
+        }
+        if (knee_lossy) {
+            fprintf(out, "%u kHz knee: lossless up to %u pkt/s, loss from %u pkt/s\n", bus_speeds[s] / 1000,
+                    knee_lossless, knee_lossy);
+        } else {
+            fprintf(out, "%u kHz: no loss up to %u pkt/s\n", bus_speeds[s] / 1000, knee_lossless);
+        }
+    }
+    stress_set_mode(false);
+
+    // Firmware reports: total loss from sequence gaps and its knee
+    fflush(stdout);
+    long len = ftell(capture);
+    char* text = malloc(len + 1);
+    rewind(capture);
+    len = fread(text, 1, len, capture);
+    text[len] = '\0';
+    uint32_t fw_lost = report_sum(text, " lost="), fw_bad = report_sum(text, " bad=");
+    const char* knee = strstr(text, "STRESS mode off");
+    fprintf(out, "firmware: lost %u bad %u (replay lost %u), %.*s", fw_lost, fw_bad, total_lost,
+            knee ? (int)(strchr(knee, '\n') - knee + 1) : 0, knee ? knee : "");
+    if (knee == NULL || fw_lost + fw_bad < total_lost) {
+        fprintf(out, "FAIL: firmware reports miss lost packets\n");
+        failures++;
+    }
+
+    // Pattern packets stayed out of the history, pyramid and features
+    speech_state_t speech;
+    speech_features_get(&speech);
+    if (spectrogram_head[0] != 0 || history_pyramid_count(0) != 0 || speech.frames != 0) {
+        fprintf(out, "FAIL: pattern packets reached the history (head %d, pyramid %u, features %u)\n",
+                spectrogram_head[0], history_pyramid_count(0), speech.frames);
+        failures++;
+    }
+
+    fprintf(out, failures ? "FAILED\n" : "OK\n");
+    fclose(out);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+// Tile-hash partial refresh: after every incremental frame the panel must
+// match a full redraw of the same rows, across color scale changes and
+// wraparound of the history ring. Also compared against the screenshot
+// composer, which does not go through the tiles at all.
+#include "spectro_render.h"
+#include "st7796_driver.h"
+#include "fake_display.h"
+#include "sim_sdk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SENTINEL 0x1234
+
+static uint8_t ring[SPECTROGRAM_DEPTH][STORE_ROW_BYTES];
+static int ring_head = 0;
+static uint16_t saved[SCREEN_H][SCREEN_W];
+static uint8_t frame_max_value = 0;  // Color scale of the last frame
+
+static void push_row(int loud) {
+    uint8_t bins[NUM_FREQ_BINS];
+    for (int i = 0; i < NUM_FREQ_BINS; i++) {
+        bins[i] = loud ? rand() % (64 * loud) : (rand() % 50 == 0) ? 3 : 0;
+    }
+    store_pack_row(bins, ring[ring_head]);
+    ring_head = (ring_head + 1) % SPECTROGRAM_DEPTH;
+}
+
+static uint32_t render(const uint8_t** rows) {
+    history_rows_build(ring, ring_head, rows);
+    uint8_t max_code = 0;
+    for (int age = 0; age < spectrogram_depth; age++) {
+        uint8_t row_max = store_row_max(rows[age]);
+        if (row_max > max_code) max_code = row_max;
+    }
+    uint8_t max_value = store_dequant(max_code);
+    if (max_value < 16) max_value = 16;
+    frame_max_value = max_value;
+    render_palette_update(max_value);
+    return render_tiles(rows, max_value);
+}
+
+static int diff_area(uint16_t (*a)[SCREEN_W], uint16_t (*b)[SCREEN_W]) {
+    int bad = 0;
+    for (int y = SPECTRO_Y; y < SPECTRO_Y + SPECTRO_VISIBLE_H; y++) {
+        for (int x = 0; x < SPECTRO_W; x++) {
+            if (a[y][x] != b[y][x]) bad++;
+        }
+    }
+    return bad;
+}
+
+// Pixels differing from the screenshot composer
+static int diff_composed(const uint8_t** rows) {
+    uint16_t line[SPECTRO_W];
+    int bad = 0;
+    for (int py = 0; py < SPECTRO_VISIBLE_H; py++) {
+        compose_spectro_row(py, rows, line);
+        for (int x = 0; x < SPECTRO_W; x++) {
+            if (fb[SPECTRO_Y + py][x] != line[x]) bad++;
+        }
+    }
+    return bad;
+}
+
+// Redraw everything over a cleared area and compare with what the
+// incremental frame left on the panel
+static int diff_full_redraw(const uint8_t** rows, bool clear_black) {
+    memcpy(saved, fb, sizeof(saved));
+    for (int y = SPECTRO_Y; y < SPECTRO_Y + SPECTRO_VISIBLE_H; y++) {
+        for (int x = 0; x < SPECTRO_W; x++) {
+            fb[y][x] = clear_black ? COLOR_BLACK : SENTINEL;
+        }
+    }
+    tile_hash_valid = false;
+    spectro_area_black = clear_black;
+    render(rows);
+    return diff_area(saved, fb);
+}
+
+int main(void) {
+    static const char* mode_names[] = {"blocks", "linear", "cubic"};
+    const uint8_t* rows[SPECTROGRAM_DEPTH];
+    int failures = 0;
+    
+    spectro_store_init();
+    srand(1);
+    
+    for (int mode = RENDER_BLOCKS; mode <= RENDER_CUBIC; mode++) {
+        render_mode = mode;
+        view_changed = true;
+        tile_hash_valid = false;
+        fb_clear(SENTINEL);
+        uint32_t wraps = 0, scale_changes = 0, quiet_tiles = 0;
+        uint8_t last_max = 0;
+        uint64_t saved_before = spi_bytes_saved;
+        
+        for (int frame = 0; frame < 300; frame++) {
+            // Phases: silence, speech at rising levels, bursts longer than the ring
+            int phase = (frame / 25) % 4;
+            int loud = (phase == 0) ? 0 : phase;
+            int n = (frame % 50 == 49) ? SPECTROGRAM_DEPTH + 7 : rand() % 8;
+            if (frame % 10 == 5) n = 0;  // Nothing new: nothing may be sent
+            
+            int head_before = ring_head;
+            for (int i = 0; i < n; i++) {
+                push_row(loud);
+            }
+            if (n > 0 && ring_head <= head_before) wraps++;
+            
+            uint32_t sent = render(rows);
+            if (frame > 0 && frame_max_value != last_max) scale_changes++;
+            last_max = frame_max_value;
+            if (n == 0 && frame > 0) {
+                quiet_tiles += sent;
+            }
+            
+            int bad_composed = diff_composed(rows);
+            int bad_full = diff_full_redraw(rows, frame % 7 == 3);
+            if (bad_composed || bad_full) {
+                printf("FAIL: %s frame %d: %d px differ from the composer, %d from a full redraw\n",
+                       mode_names[mode], frame, bad_composed, bad_full);
+                failures++;
+                break;
+            }
+        }
+        
+        printf("%-6s wraps %u, color scale changes %u, tiles sent without new rows %u, saved %llu KB\n",
+               mode_names[mode], wraps, scale_changes, quiet_tiles,
+               (unsigned long long)((spi_bytes_saved - saved_before) / 1024));
+        if (quiet_tiles != 0) {
+            printf("FAIL: %s sent tiles for frames without new rows\n", mode_names[mode]);
+            failures++;
+        }
+        if (wraps == 0 || scale_changes == 0) {
+            printf("FAIL: %s did not cover wraparound and scale changes\n", mode_names[mode]);
+            failures++;
+        }
+    }
+    
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,313 @@
+// Touch zoom/pan: scripted controller reports go through a mock register
+// transport, the gesture decoder and view_apply_gesture. After every
+// gesture the view tables must describe the visible window, a tap must keep
+// the touched cell under the finger, and the next frame must redraw exactly
+// the tiles whose hash changed: every tile showing new pixels after a view
+// change and none when the view did not change. The panel must match the
+// screenshot composer throughout.
+#include "spectro_render.h"
+#include "st7796_driver.h"
+#include "touch_driver.h"
+#include "fake_display.h"
+#include "sim_sdk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_MS 16
+
+static uint8_t ring[SPECTROGRAM_DEPTH][STORE_ROW_BYTES];
+static int ring_head = 0;
+static const uint8_t* rows[SPECTROGRAM_DEPTH];
+static uint32_t now_ms = 0;
+static int failures = 0;
+
+// FT6336 registers from TD_STATUS on, as the mock transport returns them
+static uint8_t touch_regs[5];
+
+static bool mock_read_regs(uint8_t reg, uint8_t* buf, uint8_t len) {
+    (void)reg;
+    memcpy(buf, touch_regs, len);
+    return true;
+}
+
+static bool mock_write_reg(uint8_t reg, uint8_t value) {
+    (void)reg;
+    (void)value;
+    return true;
+}
+
+static const touch_transport_t mock_transport = {
+    .read_regs = mock_read_regs,
+    .write_reg = mock_write_reg,
+};
+
+// Report a finger at screen (sx, sy). The touch driver maps the portrait
+// panel axes to landscape, and view_apply_gesture maps landscape to the
+// profile's rotation, so the report is the inverse of both.
+static void report(bool down, int sx, int sy) {
+#if (SPECTRO_ROTATION & 1) == 0
+    int tx = sy, ty = sx;
+#else
+    int tx = sx, ty = sy;
+#endif
+    int raw_x = ty, raw_y = tx;
+    touch_regs[0] = down ? 1 : 0;
+    touch_regs[1] = (down ? 0x80 : 0x40) | ((raw_x >> 8) & 0x0F);  // Contact / lift up
+    touch_regs[2] = raw_x & 0xFF;
+    touch_regs[3] = (raw_y >> 8) & 0x0F;
+    touch_regs[4] = raw_y & 0xFF;
+    touch_notify_irq();
+}
+
+static uint32_t render(void) {
+    history_rows_build(ring, ring_head, rows);
+    uint8_t max_code = 0;
+    for (int age = 0; age < spectrogram_depth; age++) {
+        uint8_t row_max = store_row_max(rows[age]);
+        if (row_max > max_code) max_code = row_max;
+    }
+    uint8_t max_value = store_dequant(max_code);
+    if (max_value < 16) max_value = 16;
+    render_palette_update(max_value);
+    return render_tiles(rows, max_value);
+}
+
+static int diff_composed(void) {
+    uint16_t line[SPECTRO_W];
+    int bad = 0;
+    for (int py = 0; py < SPECTRO_VISIBLE_H; py++) {
+        compose_spectro_row(py, rows, line);
+        for (int x = 0; x < SPECTRO_W; x++) {
+            if (fb[SPECTRO_Y + py][x] != line[x]) bad++;
+        }
+    }
+    return bad;
+}
+
+// The tables must tile the spectrogram with the visible bins and samples
+static int check_view_tables(void) {
+    int col_w = SPECTRO_PIXEL_W * view_freq_zoom;
+    int bad = 0;
+
+    if (view_num_cols != NUM_FREQ_BINS / view_freq_zoom) bad++;
+    if (view_first_bin < 0 || view_first_bin + view_num_cols > NUM_FREQ_BINS) bad++;
+    if (view_first_age < 0 || view_first_age + view_num_rows > spectrogram_depth) bad++;
+    for (int c = 0; c < view_num_cols; c++) {
+        if (view_cols[c].bin != view_first_bin + c || view_cols[c].x != c * col_w || view_cols[c].w != col_w) bad++;
+    }
+    int y = SPECTRO_Y;
+    for (int r = 0; r < view_num_rows; r++) {
+        if (view_rows[r].age != view_first_age + r || view_rows[r].y != y || view_rows[r].h < 1) bad++;
+        y += view_rows[r].h;
+    }
+    if (y != SPECTRO_Y + SPECTRO_H) bad++;
+    for (int tx = 0; tx < TILES_X; tx++) {
+        if (view_cols[tile_col_first[tx]].x > tx * TILE_W) bad++;
+        if (tile_col_end[tx] > view_num_cols) bad++;
+    }
+    return bad;
+}
+
+static uint16_t previous[SCREEN_H][SCREEN_W];
+static uint32_t previous_hash[TILES_Y][TILES_X];
+
+static bool tile_written(int tx, int ty) {
+    for (int y = ty * TILE_H; y < ty * TILE_H + TILE_VISIBLE_H(ty); y++) {
+        for (int x = tx * TILE_W; x < tx * TILE_W + TILE_W; x++) {
+            if (fb_written[SPECTRO_Y + y][x]) return true;
+        }
+    }
+    return false;
+}
+
+static bool tile_pixels_changed(int tx, int ty) {
+    for (int y = ty * TILE_H; y < ty * TILE_H + TILE_VISIBLE_H(ty); y++) {
+        if (memcmp(&fb[SPECTRO_Y + y][tx * TILE_W], &previous[SPECTRO_Y + y][tx * TILE_W], TILE_W * 2) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Visible tiles written since fb_written_clear(). The written set must be
+// exactly the tiles whose hash changed and must cover every tile that now
+// shows different pixels (distinct codes can share a color, so a tile may
+// be resent with the same pixels); mismatches are counted in *wrong.
+static int dirty_tiles(int* changed, int* wrong) {
+    int dirty = 0;
+    *changed = 0;
+    *wrong = 0;
+    for (int ty = 0; ty < TILES_Y; ty++) {
+        if (TILE_VISIBLE_H(ty) == 0) continue;
+        for (int tx = 0; tx < TILES_X; tx++) {
+            bool written = tile_written(tx, ty);
+            bool pixels = tile_pixels_changed(tx, ty);
+            bool hash = tile_hash[ty][tx] != previous_hash[ty][tx];
+            dirty += written;
+            *changed += pixels;
+            if (written != hash || (pixels && !written)) (*wrong)++;
+        }
+    }
+    return dirty;
+}
+
+// Bin and age under a screen point in the current view
+static void cell_at(int sx, int sy, int* bin, int* age) {
+    *bin = view_first_bin + sx / (SPECTRO_PIXEL_W * view_freq_zoom);
+    *age = view_first_age + view_row_at(sy - SPECTRO_Y, view_num_rows);
+}
+
+// Poll the touch driver once, apply the gesture and render a frame. Returns
+// the gesture type that changed the view, or TOUCH_GESTURE_NONE.
+static touch_gesture_type_t step(const char* what) {
+    touch_gesture_t gesture;
+    touch_gesture_type_t applied = TOUCH_GESTURE_NONE;
+    if (touch_poll(now_ms, &gesture)) {
+        touch_gesture_type_t type = gesture.type;
+        if (view_apply_gesture(&gesture)) applied = type;
+    }
+    now_ms += FRAME_MS;
+
+    fb_written_clear();
+    memcpy(previous, fb, sizeof(previous));
+    memcpy(previous_hash, tile_hash, sizeof(previous_hash));
+    uint32_t sent = render();
+    int changed, wrong;
+    int dirty = dirty_tiles(&changed, &wrong);
+    int bad_tables = check_view_tables();
+    int bad_pixels = diff_composed();
+
+    if (applied != TOUCH_GESTURE_NONE) {
+        printf("%-14s zoom %ux first bin %2d first age %3d, %3u tiles sent, %3d dirty, %3d changed\n",
+               what, view_freq_zoom, view_first_bin, view_first_age, sent, dirty, changed);
+    }
+    if (dirty != (int)sent || wrong) {
+        printf("FAIL: %s: %u tiles sent, %d dirty, %d changed, %d not matching the hashes\n",
+               what, sent, dirty, changed, wrong);
+        failures++;
+    } else if (applied != TOUCH_GESTURE_NONE && dirty == 0) {
+        printf("FAIL: %s: nothing redrawn after a view change\n", what);
+        failures++;
+    } else if (applied == TOUCH_GESTURE_NONE && dirty != 0) {
+        printf("FAIL: %s: %d tiles redrawn without a view change\n", what, dirty);
+        failures++;
+    }
+    if (bad_tables) {
+        printf("FAIL: %s: %d view table entries inconsistent\n", what, bad_tables);
+        failures++;
+    }
+    if (bad_pixels) {
+        printf("FAIL: %s: %d px differ from the composer\n", what, bad_pixels);
+        failures++;
+    }
+    return applied;
+}
+
+// Tap at a screen point; the cell under the finger must stay there unless
+// the view zooms back out to the whole history
+static void tap(int sx, int sy, uint8_t expect_zoom) {
+    int bin, age;
+    cell_at(sx, sy, &bin, &age);
+    report(true, sx, sy);
+    step("press");
+    report(false, sx, sy);
+    if (step("tap") != TOUCH_GESTURE_TAP || view_freq_zoom != expect_zoom) {
+        printf("FAIL: tap at (%d, %d) did not zoom to %ux\n", sx, sy, expect_zoom);
+        failures++;
+        return;
+    }
+    int new_bin, new_age;
+    cell_at(sx, sy, &new_bin, &new_age);
+    if (expect_zoom > 1 && (new_bin != bin || new_age != age)) {
+        printf("FAIL: tap at (%d, %d) moved cell (%d, %d) to (%d, %d)\n", sx, sy, bin, age, new_bin, new_age);
+        failures++;
+    }
+}
+
+// Drag from (sx, sy) by (dx, dy) in steps; content must follow the finger
+// by whole cells, clamped to the history
+static void drag(int sx, int sy, int dx, int dy, int steps) {
+    int col_w = SPECTRO_PIXEL_W * view_freq_zoom;
+    int row_h = SPECTRO_H / view_num_rows;
+    int expect_bin = view_first_bin - dx / col_w;
+    int expect_age = view_first_age - dy / row_h;
+    int max_bin = NUM_FREQ_BINS - view_num_cols;
+    int max_age = spectrogram_depth - view_num_rows;
+    expect_bin = (expect_bin < 0) ? 0 : (expect_bin > max_bin) ? max_bin : expect_bin;
+    expect_age = (expect_age < 0) ? 0 : (expect_age > max_age) ? max_age : expect_age;
+
+    report(true, sx, sy);
+    step("press");
+    for (int i = 1; i <= steps; i++) {
+        report(true, sx + dx * i / steps, sy + dy * i / steps);
+        step("drag");
+    }
+    report(false, sx + dx, sy + dy);
+    step("lift");
+    if (view_first_bin != expect_bin || view_first_age != expect_age) {
+        printf("FAIL: drag by (%d, %d) ended at bin %d age %d, expected %d %d\n",
+               dx, dy, view_first_bin, view_first_age, expect_bin, expect_age);
+        failures++;
+    }
+}
+
+int main(void) {
+    spectro_store_init();
+    touch_init(&mock_transport);
+    srand(3);
+
+    uint8_t bins[NUM_FREQ_BINS];
+    for (int r = 0; r < SPECTROGRAM_DEPTH; r++) {
+        for (int i = 0; i < NUM_FREQ_BINS; i++) {
+            bins[i] = (i > 10 && i < 20) ? rand() % 256 : rand() % 8;
+        }
+        store_pack_row(bins, ring[ring_head]);
+        ring_head = (ring_head + 1) % SPECTROGRAM_DEPTH;
+    }
+    fb_clear(COLOR_BLACK);
+    tile_hash_valid = false;
+    spectro_area_black = true;
+    render();
+
+    int mid_x = SPECTRO_W / 2 + 5;
+    int mid_y = SPECTRO_Y + SPECTRO_VISIBLE_H / 2;
+
+    // Zoom in twice around the middle, pan, then cycle back to 1x
+    tap(mid_x, mid_y, 2);
+    tap(mid_x, mid_y, 4);
+    drag(mid_x, mid_y, -3 * SPECTRO_PIXEL_W * 4 - 2, 0, 6);
+    drag(mid_x, mid_y, 0, SPECTRO_VISIBLE_H / 4, 5);
+    while (view_first_bin > 0) {
+        drag(20, mid_y, SPECTRO_W - 40, 0, 4);  // Towards the lowest bin
+    }
+
+    // A drag at the clamp and a long press change nothing
+    drag(20, mid_y, SPECTRO_W - 40, 0, 3);
+    for (uint32_t held = 0; held <= TOUCH_TAP_MAX_MS; held += FRAME_MS) {
+        report(true, 20, mid_y);
+        step("hold");
+    }
+    report(false, 20, mid_y);
+    if (step("long press") != TOUCH_GESTURE_NONE) {
+        printf("FAIL: a long press changed the view\n");
+        failures++;
+    }
+
+    tap(SPECTRO_PIXEL_W * 4 + 3, SPECTRO_Y + 7, 1);
+
+    // At 1x the whole history is visible, so a drag cannot pan
+    drag(mid_x, mid_y, -SPECTRO_W / 3, -SPECTRO_VISIBLE_H / 3, 4);
+
+    // Taps outside the spectrogram are ignored
+    report(true, 10, 5);
+    step("press");
+    report(false, 10, 5);
+    if (step("header tap") != TOUCH_GESTURE_NONE) {
+        printf("FAIL: tap on the header changed the view\n");
+        failures++;
+    }
+
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
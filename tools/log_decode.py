@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Decode binary deferred-log records from the I2C test device.
+
+Enable binary log output first (SET_PARAM 0x0B = 1), then either read a raw
+capture of the USB serial stream or the port itself:
+
+    python3 tools/log_decode.py capture.bin
+    python3 tools/log_decode.py --port /dev/ttyACM0      (needs pyserial)
+
+Message formats are read from log_messages.h, so the decoder always matches
+the firmware it was built from. Bytes outside control frames (ordinary text
+output) are passed through unchanged with --text.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+RESPONSE_SOF = 0x5A
+CMD_LOG_RECORD = 0x86
+CONVERSION = re.compile(r"%[-+ #0-9.]*[diuxXc]")
+
+DEFAULT_TABLE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "log_messages.h")
+
+
+def load_formats(path):
+    """Message formats in id order, from the X(id, format) table."""
+    with open(path) as f:
+        text = f.read()
+    return [(name, fmt) for name, fmt in re.findall(r'X\((\w+),\s*"((?:[^"\\]|\\.)*)"\)', text)]
+
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def format_record(formats, payload):
+    core = payload[0]
+    msg_id = payload[1] | (payload[2] << 8)
+    timestamp_us = int.from_bytes(payload[3:7], "little")
+    args = [int.from_bytes(payload[i:i + 4], "little") for i in range(7, len(payload), 4)]
+
+    if msg_id < len(formats):
+        name, fmt = formats[msg_id]
+        count = len(CONVERSION.findall(fmt))
+        values = tuple(args[:count]) + (0,) * (count - len(args))
+        try:
+            message = fmt % values
+        except (TypeError, ValueError):
+            message = "%s %s" % (name, args)
+    else:
+        message = "unknown message %d %s" % (msg_id, args)
+    return "%10.6f C%d %s" % (timestamp_us / 1e6, core, message)
+
+
+def decode(stream, formats, show_text):
+    """Scan a byte stream for log frames; yields output lines."""
+    buf = bytearray()
+    text = bytearray()
+    for chunk in stream:
+        buf += chunk
+        while buf:
+            if buf[0] != RESPONSE_SOF:
+                text.append(buf.pop(0))
+                if show_text and text.endswith(b"\n"):
+                    yield text.decode(errors="replace").rstrip("\n")
+                    text.clear()
+                continue
+            if len(buf) < 4:
+                break
+            length = buf[2] | (buf[3] << 8)
+            if len(buf) < 5 + length:
+                break
+            frame = buf[1:4 + length]
+            if crc8(frame) != buf[4 + length]:
+                text.append(buf.pop(0))  # Not a frame, 0x5A was ordinary text
+                continue
+            if frame[0] == CMD_LOG_RECORD and length >= 7:
+                yield format_record(formats, bytes(frame[3:]))
+            del buf[:5 + length]
+
+
+def read_file(path):
+    with open(path, "rb") as f:
+        while True:
+            chunk = f.read(4096)
+            if not chunk:
+                return
+            yield chunk
+
+
+def read_port(port):
+    import serial  # pyserial
+    with serial.Serial(port, 115200, timeout=0.1) as s:
+        while True:
+            chunk = s.read(4096)
+            if chunk:
+                yield chunk
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", nargs="?", help="raw capture file (default: stdin)")
+    parser.add_argument("--port", help="read from a serial port instead")
+    parser.add_argument("--table", default=DEFAULT_TABLE, help="path to log_messages.h")
+    parser.add_argument("--text", action="store_true", help="also print plain text output")
+    args = parser.parse_args()
+
+    formats = load_formats(args.table)
+    if args.port:
+        stream = read_port(args.port)
+    elif args.capture:
+        stream = read_file(args.capture)
+    else:
+        stream = iter(lambda: sys.stdin.buffer.read1(4096), b"")
+
+    try:
+        for line in decode(stream, formats, args.text):
+            print(line, flush=True)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,296 @@
+#include "touch_driver.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Touch controller pins. GPIO 8/9 belong to hardware I2C0, which is already
+// the FFT slave port, so the touch bus is driven by a software I2C master.
+#define PIN_SDA 8
+#define PIN_SCL 9
+#define PIN_RST 10
+#define PIN_INT 11
+
+#define I2C_HALF_PERIOD_US 5    // ~100 kHz
+#define I2C_STRETCH_TIMEOUT_US 1000
+
+// FT6336 registers
+#define FT_REG_TD_STATUS  0x02  // Number of touch points, followed by P1_XH..P1_YL
+#define FT_REG_G_MODE     0xA4  // Interrupt mode
+#define FT_G_MODE_TRIGGER 0x01  // Pulse INT for every new report
+#define FT_EVENT_LIFT_UP  0x01
+
+static const touch_transport_t* transport = NULL;
+static volatile bool irq_pending = false;
+static bool finger_down = false;
+static int16_t finger_x = 0;
+static int16_t finger_y = 0;
+static uint32_t last_report_ms = 0;
+
+// Gesture decoder state
+static bool gs_down = false;
+static bool gs_dragging = false;
+static int16_t gs_start_x, gs_start_y;
+static int16_t gs_last_x, gs_last_y;
+static uint32_t gs_start_ms;
+
+// Software I2C: lines are open-drain, driven low or released to the pull-ups
+static inline void line_low(uint pin) {
+    gpio_set_dir(pin, GPIO_OUT);
+}
+
+static inline void line_release(uint pin) {
+    gpio_set_dir(pin, GPIO_IN);
+}
+
+static inline void i2c_delay(void) {
+    busy_wait_us_32(I2C_HALF_PERIOD_US);
+}
+
+// Release SCL and wait for the slave to stop stretching the clock
+static bool scl_release(void) {
+    line_release(PIN_SCL);
+    for (uint32_t t = 0; t < I2C_STRETCH_TIMEOUT_US; t++) {
+        if (gpio_get(PIN_SCL)) return true;
+        busy_wait_us_32(1);
+    }
+    return false;
+}
+
+static bool i2c_start(void) {
+    line_release(PIN_SDA);
+    if (!scl_release()) return false;
+    i2c_delay();
+    line_low(PIN_SDA);
+    i2c_delay();
+    line_low(PIN_SCL);
+    return true;
+}
+
+static void i2c_stop(void) {
+    line_low(PIN_SDA);
+    i2c_delay();
+    scl_release();
+    i2c_delay();
+    line_release(PIN_SDA);
+    i2c_delay();
+}
+
+// Write one byte, returns true if the slave acknowledged
+static bool i2c_write_byte(uint8_t byte) {
+    for (int i = 0; i < 8; i++) {
+        if (byte & 0x80) {
+            line_release(PIN_SDA);
+        } else {
+            line_low(PIN_SDA);
+        }
+        byte <<= 1;
+        i2c_delay();
+        if (!scl_release()) return false;
+        i2c_delay();
+        line_low(PIN_SCL);
+    }
+
+    line_release(PIN_SDA);
+    i2c_delay();
+    if (!scl_release()) return false;
+    bool ack = !gpio_get(PIN_SDA);
+    i2c_delay();
+    line_low(PIN_SCL);
+    return ack;
+}
+
+static uint8_t i2c_read_byte(bool ack) {
+    uint8_t byte = 0;
+    line_release(PIN_SDA);
+    for (int i = 0; i < 8; i++) {
+        i2c_delay();
+        scl_release();
+        byte = (byte << 1) | (gpio_get(PIN_SDA) ? 1 : 0);
+        i2c_delay();
+        line_low(PIN_SCL);
+    }
+
+    if (ack) {
+        line_low(PIN_SDA);
+    }
+    i2c_delay();
+    scl_release();
+    i2c_delay();
+    line_low(PIN_SCL);
+    line_release(PIN_SDA);
+    return byte;
+}
+
+static bool bitbang_read_regs(uint8_t reg, uint8_t* buf, uint8_t len) {
+    bool ok = i2c_start() &&
+              i2c_write_byte(TOUCH_I2C_ADDR << 1) &&
+              i2c_write_byte(reg) &&
+              i2c_start() &&  // Repeated start
+              i2c_write_byte((TOUCH_I2C_ADDR << 1) | 1);
+    if (ok) {
+        for (uint8_t i = 0; i < len; i++) {
+            buf[i] = i2c_read_byte(i + 1 < len);
+        }
+    }
+    i2c_stop();
+    return ok;
+}
+
+static bool bitbang_write_reg(uint8_t reg, uint8_t value) {
+    bool ok = i2c_start() &&
+              i2c_write_byte(TOUCH_I2C_ADDR << 1) &&
+              i2c_write_byte(reg) &&
+              i2c_write_byte(value);
+    i2c_stop();
+    return ok;
+}
+
+static const touch_transport_t bitbang_transport = {
+    .read_regs = bitbang_read_regs,
+    .write_reg = bitbang_write_reg,
+};
+
+static void touch_gpio_callback(uint gpio, uint32_t events) {
+    if (gpio == PIN_INT) {
+        touch_notify_irq();
+    }
+}
+
+// Initialize the touch controller
+void touch_init(const touch_transport_t* custom_transport) {
+    if (custom_transport != NULL) {
+        transport = custom_transport;
+        return;
+    }
+
+    printf("Touch: Initializing software I2C (SDA=%d, SCL=%d)\n", PIN_SDA, PIN_SCL);
+    gpio_init(PIN_SDA);
+    gpio_init(PIN_SCL);
+    gpio_pull_up(PIN_SDA);
+    gpio_pull_up(PIN_SCL);
+    gpio_put(PIN_SDA, 0);  // Output latch low: setting the direction drives low
+    gpio_put(PIN_SCL, 0);
+    line_release(PIN_SDA);
+    line_release(PIN_SCL);
+    transport = &bitbang_transport;
+
+    gpio_init(PIN_INT);
+    gpio_set_dir(PIN_INT, GPIO_IN);
+    gpio_pull_up(PIN_INT);
+
+    // Hardware reset
+    gpio_init(PIN_RST);
+    gpio_set_dir(PIN_RST, GPIO_OUT);
+    gpio_put(PIN_RST, 0);
+    sleep_ms(5);
+    gpio_put(PIN_RST, 1);
+    sleep_ms(300);
+
+    if (transport->write_reg(FT_REG_G_MODE, FT_G_MODE_TRIGGER)) {
+        printf("Touch: Controller ready at 0x%02X\n", TOUCH_I2C_ADDR);
+    } else {
+        printf("Touch: No controller found at 0x%02X\n", TOUCH_I2C_ADDR);
+    }
+}
+
+// Route TPINT to the calling core (GPIO callbacks are per core)
+void touch_enable_irq(void) {
+    gpio_set_irq_enabled_with_callback(PIN_INT, GPIO_IRQ_EDGE_FALL, true, &touch_gpio_callback);
+}
+
+// Mark a new report as available (TPINT edge or scripted event)
+void touch_notify_irq(void) {
+    irq_pending = true;
+}
+
+// Read the pending report (if any) and decode it into a gesture
+bool touch_poll(uint32_t now_ms, touch_gesture_t* gesture) {
+    bool down = finger_down;
+
+    if (irq_pending) {
+        irq_pending = false;
+
+        uint8_t regs[5];
+        if (transport == NULL || !transport->read_regs(FT_REG_TD_STATUS, regs, sizeof(regs))) {
+            return false;
+        }
+
+        uint8_t points = regs[0] & 0x0F;
+        uint8_t event = regs[1] >> 6;
+        down = (points > 0) && (event != FT_EVENT_LIFT_UP);
+
+        if (down) {
+            // Panel X/Y are portrait; landscape matches st7796_set_rotation(1)
+            int16_t raw_x = ((regs[1] & 0x0F) << 8) | regs[2];
+            int16_t raw_y = ((regs[3] & 0x0F) << 8) | regs[4];
+            finger_x = raw_y;
+            finger_y = raw_x;
+        }
+        last_report_ms = now_ms;
+    } else if (finger_down && (now_ms - last_report_ms) > TOUCH_RELEASE_MS) {
+        down = false;  // Missed the lift-up report
+    } else {
+        return false;
+    }
+
+    finger_down = down;
+    return touch_gesture_feed(down, finger_x, finger_y, now_ms, gesture);
+}
+
+// Gesture decoder: turns press/move/release samples into tap and drag events
+bool touch_gesture_feed(bool down, int16_t x, int16_t y, uint32_t now_ms, touch_gesture_t* gesture) {
+    gesture->type = TOUCH_GESTURE_NONE;
+    gesture->x = x;
+    gesture->y = y;
+    gesture->dx = 0;
+    gesture->dy = 0;
+
+    if (down && !gs_down) {
+        // Press
+        gs_down = true;
+        gs_dragging = false;
+        gs_start_x = gs_last_x = x;
+        gs_start_y = gs_last_y = y;
+        gs_start_ms = now_ms;
+        return false;
+    }
+
+    if (down) {
+        // Move
+        if (!gs_dragging) {
+            if (abs(x - gs_start_x) <= TOUCH_TAP_SLOP_PX && abs(y - gs_start_y) <= TOUCH_TAP_SLOP_PX) {
+                return false;
+            }
+            gs_dragging = true;
+        }
+
+        gesture->dx = x - gs_last_x;
+        gesture->dy = y - gs_last_y;
+        gs_last_x = x;
+        gs_last_y = y;
+        if (gesture->dx == 0 && gesture->dy == 0) return false;
+
+        gesture->type = TOUCH_GESTURE_DRAG;
+        return true;
+    }
+
+    if (!gs_down) return false;
+
+    // Release
+    gs_down = false;
+    if (gs_dragging) {
+        gesture->type = TOUCH_GESTURE_DRAG_END;
+        gesture->x = gs_last_x;
+        gesture->y = gs_last_y;
+        return true;
+    }
+
+    if ((now_ms - gs_start_ms) <= TOUCH_TAP_MAX_MS) {
+        gesture->type = TOUCH_GESTURE_TAP;
+        gesture->x = gs_start_x;
+        gesture->y = gs_start_y;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,41 @@
+#ifndef TOUCH_DRIVER_H
+#define TOUCH_DRIVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// FT6336 capacitive touch controller
+#define TOUCH_I2C_ADDR 0x38
+
+// Gesture thresholds
+#define TOUCH_TAP_MAX_MS      300   // Longest press still reported as a tap
+#define TOUCH_TAP_SLOP_PX     10    // Movement before a press becomes a drag
+#define TOUCH_RELEASE_MS      100   // No report for this long = finger lifted
+
+// Register transport, so gestures can be scripted without the controller
+typedef struct {
+    bool (*read_regs)(uint8_t reg, uint8_t* buf, uint8_t len);
+    bool (*write_reg)(uint8_t reg, uint8_t value);
+} touch_transport_t;
+
+typedef enum {
+    TOUCH_GESTURE_NONE = 0,
+    TOUCH_GESTURE_TAP,       // Short press without movement at (x, y)
+    TOUCH_GESTURE_DRAG,      // Finger moved by (dx, dy) since the last drag event
+    TOUCH_GESTURE_DRAG_END,  // Finger lifted after a drag
+} touch_gesture_type_t;
+
+typedef struct {
+    touch_gesture_type_t type;
+    int16_t x, y;    // Current position in screen coordinates (landscape)
+    int16_t dx, dy;  // Drag delta
+} touch_gesture_t;
+
+// Function prototypes
+void touch_init(const touch_transport_t* transport);  // NULL = bit-banged I2C on GPIO 8/9
+void touch_enable_irq(void);                           // Call on the core that polls
+void touch_notify_irq(void);
+bool touch_poll(uint32_t now_ms, touch_gesture_t* gesture);
+bool touch_gesture_feed(bool down, int16_t x, int16_t y, uint32_t now_ms, touch_gesture_t* gesture);
+
+#endif // TOUCH_DRIVER_H